@@ -0,0 +1,886 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.cpp
+//
+// Identification: src/buffer/buffer_pool_manager_instance.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <future>  // NOLINT
+#include <list>
+#include <memory>
+#include <new>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacementPolicy policy,
+                                                     const FrameArenaOptions &arena_options)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, policy, arena_options) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacementPolicy policy, const FrameArenaOptions &arena_options)
+    : pool_size_(0),
+      capacity_(std::max(pool_size, arena_options.max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      arena_(capacity_, arena_options),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(2 * pool_size),
+      frame_states_(std::make_unique<std::atomic<FrameState>[]>(capacity_)) {
+  BUSTUB_ASSERT(num_instances > 0, "A stand-alone instance is a pool of exactly one instance.");
+  BUSTUB_ASSERT(instance_index < num_instances, "Instance index must be smaller than the number of instances.");
+  // We reserve a consecutive address space for the largest pool that Resize may grow to, both here for the Pages and
+  // in arena_ for their data. Memory is only committed for the frames that are actually constructed.
+  void *arena = mmap(nullptr, capacity_ * sizeof(Page), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  BUSTUB_ASSERT(arena != MAP_FAILED, "Couldn't reserve memory for the buffer pool.");
+  pages_ = static_cast<Page *>(arena);
+  switch (policy) {
+    case ReplacementPolicy::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacementPolicy::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacementPolicy::CLOCK_PRO:
+      replacer_ = new ClockProReplacer(pool_size);
+      break;
+    case ReplacementPolicy::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
+
+  // Initially, every page is in the free list.
+  Grow(pool_size);
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundWriter();
+  {
+    std::scoped_lock guard(prefetch_latch_);
+    prefetch_shutdown_ = true;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  // Asynchronous read-ahead completes into the frames of this instance.
+  if (async_disk_manager_ != nullptr) {
+    async_disk_manager_->WaitForAll();
+  }
+  for (size_t i = 0; i < num_constructed_; ++i) {
+    pages_[i].~Page();
+  }
+  munmap(pages_, capacity_ * sizeof(Page));
+  delete replacer_;
+}
+
+bool BufferPoolManagerInstance::Resize(size_t pool_size) {
+  std::scoped_lock resize_guard(resize_latch_);
+  std::unique_lock lock(latch_);
+  if (pool_size == 0 || pool_size > capacity_) {
+    return false;
+  }
+  if (pool_size >= pool_size_) {
+    Grow(pool_size);
+    return true;
+  }
+  // 1.   Every frame that goes away must be idle: unpinned, and with no I/O in flight. Claiming the resident ones
+  //      keeps hits from pinning them from now on; if one of them cannot be claimed, the others are released again.
+  const size_t old_pool_size = pool_size_;
+  std::vector<frame_id_t> claimed;
+  for (size_t i = pool_size; i < old_pool_size; ++i) {
+    const auto frame_id = static_cast<frame_id_t>(i);
+    if (frame_states_[i] == FrameState::FREE) {
+      continue;
+    }
+    if (frame_writeback_[i] || frame_states_[i] != FrameState::READY || !ClaimFrame(frame_id)) {
+      for (auto claimed_frame_id : claimed) {
+        pages_[claimed_frame_id].pin_count_ = 0;
+      }
+      return false;
+    }
+    claimed.push_back(frame_id);
+  }
+  // 2.   Take the frames out of circulation. Clean pages leave the page table right away. Dirty pages stay in it,
+  //      EVICTING, until they are on disk, so that nobody reads a stale copy from disk in the meantime.
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  replacer_->Resize(pool_size);
+  std::vector<frame_id_t> write_back;
+  for (auto frame_id : claimed) {
+    if (pages_[frame_id].is_dirty_) {
+      frame_states_[frame_id] = FrameState::EVICTING;
+      write_back.push_back(frame_id);
+    } else {
+      page_table_.Erase(pages_[frame_id].page_id_);
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+      frame_states_[frame_id] = FrameState::FREE;
+    }
+  }
+  // 3.   Write back the dirty pages with the latch released, like an eviction does.
+  if (!write_back.empty()) {
+    lock.unlock();
+    for (auto frame_id : write_back) {
+      disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].data_);
+    }
+    lock.lock();
+    for (auto frame_id : write_back) {
+      page_table_.Erase(pages_[frame_id].page_id_);
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+      pages_[frame_id].is_dirty_ = false;
+      frame_states_[frame_id] = FrameState::FREE;
+      frame_cv_[frame_id].notify_all();
+    }
+  }
+  // 4.   Retire the frames, which stay UNPINNABLE, and return the memory of their data.
+  frame_writeback_.resize(pool_size);
+  pool_size_ = pool_size;
+  writer_cursor_ = writer_cursor_ < pool_size ? writer_cursor_ : 0;
+  arena_.Release(pool_size);
+  return true;
+}
+
+Page *BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id) {
+  frame_id_t frame_id;
+  // 0.     Serve hits without the latch. Whatever the lock-free lookup misses is looked up again below.
+  if (page_table_.Find(page_id, &frame_id) && TryPinResident(frame_id, page_id)) {
+    return &pages_[frame_id];
+  }
+  std::unique_lock lock(latch_);
+  // 1.     Search the page table for the requested page (P).
+  // 1.1    If P exists, pin it and return it immediately. If P is still being read in by another thread, pin it so
+  //        that it stays put and wait for that read to finish.
+  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+  //        Note that pages are always found from the free list first.
+  while (true) {
+    if (FindFrame(&lock, page_id, &frame_id, true)) {
+      if (pages_[frame_id].pin_count_++ == 0) {
+        replacer_->Pin(frame_id);
+      }
+      frame_cv_[frame_id].wait(lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+      return &pages_[frame_id];
+    }
+    if (AcquireFrame(&frame_id)) {
+      break;
+    }
+    // The only evictable frames are being written by the background writer. Wait for it, then look again, since P
+    // may have been read in by someone else in the meantime.
+    if (!WaitForWriteback(&lock)) {
+      return nullptr;
+    }
+  }
+  // 2.     If R is dirty, write it back to the disk. 3. Delete R from the page table and insert P.
+  InstallPage(&lock, frame_id, page_id);
+  // 4.     Read in the page content from disk with the latch released, and then return a pointer to P.
+  //        Other threads that want P wait on this frame until it is READY.
+  lock.unlock();
+  pages_[frame_id].ResetMemory();
+  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+  lock.lock();
+  frame_states_[frame_id] = FrameState::READY;
+  frame_cv_[frame_id].notify_all();
+  return &pages_[frame_id];
+}
+
+bool BufferPoolManagerInstance::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // The lock-free lookup can miss an entry that is being moved by an erase; only a miss under the latch is final.
+    std::scoped_lock guard(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+  }
+  // A pinned page cannot leave its frame, so none of this needs the latch. The dirty flag is set before the pin is
+  // dropped, so that whoever evicts the page next sees it.
+  Page &page = pages_[frame_id];
+  if (page.page_id_ != page_id) {
+    return false;
+  }
+  if (is_dirty) {
+    page.is_dirty_ = true;
+  }
+  int pin_count = page.pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPageImpl(page_id_t page_id) {
+  std::unique_lock lock(latch_);
+  // Make sure you call DiskManager::WritePage!
+  frame_id_t frame_id;
+  if (!FindFrame(&lock, page_id, &frame_id)) {
+    return false;
+  }
+  // Pin the page so that it cannot be evicted while the latch is released for the write. The dirty flag is cleared
+  // up front, so a concurrent UnpinPage(page_id, true) during the write leaves the page dirty again.
+  if (pages_[frame_id].pin_count_++ == 0) {
+    replacer_->Pin(frame_id);
+  }
+  pages_[frame_id].is_dirty_ = false;
+  lock.unlock();
+  disk_manager_->WritePage(page_id, pages_[frame_id].data_);
+  lock.lock();
+  if (--pages_[frame_id].pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+Page *BufferPoolManagerInstance::NewPageImpl(page_id_t *page_id) { return NewPageNearImpl(page_id, INVALID_PAGE_ID); }
+
+Page *BufferPoolManagerInstance::NewPageNearImpl(page_id_t *page_id, page_id_t near_page_id) {
+  std::unique_lock lock(latch_);
+  frame_id_t frame_id;
+  // 1.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  //      If all the pages in the buffer pool are pinned, return nullptr.
+  while (!AcquireFrame(&frame_id)) {
+    if (!WaitForWriteback(&lock)) {
+      return nullptr;
+    }
+  }
+  // 2.   Update P's metadata, zero out memory and add P to the page table.
+  // 3.   Set the page ID output parameter. Return a pointer to P.
+  *page_id = AllocatePage(near_page_id);
+  InstallPage(&lock, frame_id, *page_id);
+  pages_[frame_id].ResetMemory();
+  frame_states_[frame_id] = FrameState::READY;
+  frame_cv_[frame_id].notify_all();
+  return &pages_[frame_id];
+}
+
+bool BufferPoolManagerInstance::DeletePageImpl(page_id_t page_id) {
+  std::unique_lock lock(latch_);
+  // 0.   Make sure you call DiskManager::DeallocatePage!
+  // 1.   Search the page table for the requested page (P).
+  // 1.   If P does not exist, return true.
+  //      A page that is only on disk is deallocated all the same.
+  frame_id_t frame_id;
+  if (!FindFrame(&lock, page_id, &frame_id)) {
+    disk_manager_->DeallocatePage(page_id);
+    return true;
+  }
+  while (frame_writeback_[frame_id]) {
+    // Let the background writer finish with the frame before it is recycled, then look again.
+    writeback_cv_.wait(lock);
+    if (!FindFrame(&lock, page_id, &frame_id)) {
+      disk_manager_->DeallocatePage(page_id);
+      return true;
+    }
+  }
+  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  if (!ClaimFrame(frame_id)) {
+    return false;
+  }
+  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  //      The frame stays UNPINNABLE while it is free.
+  disk_manager_->DeallocatePage(page_id);
+  replacer_->Pin(frame_id);
+  page_table_.Erase(page_id);
+  frame_states_[frame_id] = FrameState::FREE;
+  pages_[frame_id].ResetMemory();
+  pages_[frame_id].Unswizzle();
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  free_list_.emplace_back(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPagesImpl() {
+  // Clean pages are already on disk, so only the dirty ones are written, in one batch and with one sync.
+  std::vector<Page *> pages;
+  PinDirtyPages(&pages);
+  const std::vector<Page *> failed = WritePagesInOrder(disk_manager_, pages);
+  UnpinFlushedPages(pages, failed);
+  disk_manager_->SyncDataFile();
+}
+
+void BufferPoolManagerInstance::PinDirtyPages(std::vector<Page *> *pages) {
+  std::scoped_lock guard(latch_);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    Page &page = pages_[i];
+    if (frame_states_[i] != FrameState::READY || !page.is_dirty_) {
+      continue;
+    }
+    // Pinned like in FlushPageImpl, so that the frame is not evicted while latch_ is released for the write.
+    if (page.pin_count_++ == 0) {
+      replacer_->Pin(static_cast<frame_id_t>(i));
+    }
+    page.is_dirty_ = false;
+    pages->push_back(&page);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinFlushedPages(const std::vector<Page *> &pages, const std::vector<Page *> &failed) {
+  const std::unordered_set<Page *> failed_set(failed.begin(), failed.end());
+  std::scoped_lock guard(latch_);
+  for (Page *page : pages) {
+    // The change that failed to write must not be lost when the page is evicted.
+    if (failed_set.count(page) != 0) {
+      page->is_dirty_ = true;
+    }
+    if (--page->pin_count_ == 0) {
+      replacer_->Unpin(static_cast<frame_id_t>(page - pages_));
+    }
+  }
+}
+
+std::vector<Page *> BufferPoolManagerInstance::WritePagesInOrder(DiskManager *disk_manager, std::vector<Page *> pages) {
+  std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->GetPageId() < b->GetPageId(); });
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> data;
+  page_ids.reserve(pages.size());
+  data.reserve(pages.size());
+  for (Page *page : pages) {
+    page_ids.push_back(page->GetPageId());
+    data.push_back(page->GetData());
+  }
+  const std::vector<bool> written = disk_manager->WritePages(page_ids, data);
+  std::vector<Page *> failed;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    if (!written[i]) {
+      failed.push_back(pages[i]);
+    }
+  }
+  return failed;
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  if (page_ids.empty()) {
+    return;
+  }
+  {
+    std::scoped_lock guard(prefetch_latch_);
+    if (!prefetch_thread_.joinable()) {
+      prefetch_thread_ = std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+    }
+    prefetch_queue_.insert(prefetch_queue_.end(), page_ids.begin(), page_ids.end());
+  }
+  prefetch_cv_.notify_one();
+}
+
+bool BufferPoolManagerInstance::SaveSnapshot() { return disk_manager_->WriteSnapshot(GetResidentPages()); }
+
+bool BufferPoolManagerInstance::LoadSnapshot() {
+  std::vector<page_id_t> page_ids;
+  if (!disk_manager_->ReadSnapshot(&page_ids)) {
+    return false;
+  }
+  WarmUp(page_ids);
+  return true;
+}
+
+std::vector<page_id_t> BufferPoolManagerInstance::GetResidentPages() {
+  std::scoped_lock guard(latch_);
+  std::vector<frame_id_t> victim_order;
+  replacer_->GetVictimOrder(&victim_order);
+  const size_t pool_size = pool_size_;
+  std::vector<bool> listed(pool_size, false);
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(page_table_.Size());
+  auto list_frame = [&](size_t frame_id) {
+    if (frame_id < pool_size && !listed[frame_id] && frame_states_[frame_id] == FrameState::READY) {
+      listed[frame_id] = true;
+      page_ids.push_back(pages_[frame_id].page_id_);
+    }
+  };
+  // The unpinned frames from the next victim on, then the pinned ones, which are in use and therefore the hottest.
+  for (auto frame_id : victim_order) {
+    list_frame(frame_id);
+  }
+  for (size_t frame_id = 0; frame_id < pool_size; ++frame_id) {
+    list_frame(frame_id);
+  }
+  return page_ids;
+}
+
+void BufferPoolManagerInstance::WarmUp(const std::vector<page_id_t> &page_ids) {
+  std::vector<page_id_t> order;
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID && static_cast<uint32_t>(page_id) % num_instances_ == instance_index_) {
+      order.push_back(page_id);
+    }
+  }
+  const size_t pool_size = pool_size_;
+  if (order.size() > pool_size) {
+    order.erase(order.begin(), order.end() - static_cast<std::ptrdiff_t>(pool_size));
+  }
+  if (order.empty()) {
+    return;
+  }
+  std::vector<page_id_t> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  {
+    std::scoped_lock guard(prefetch_latch_);
+    if (!prefetch_thread_.joinable()) {
+      prefetch_thread_ = std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+    }
+    warmup_queue_.insert(warmup_queue_.end(), sorted.begin(), sorted.end());
+    warmup_order_.insert(warmup_order_.end(), order.begin(), order.end());
+  }
+  prefetch_cv_.notify_one();
+}
+
+std::vector<Page *> BufferPoolManagerInstance::FetchPages(std::vector<page_id_t> *page_ids) {
+  std::sort(page_ids->begin(), page_ids->end());
+  page_ids->erase(std::unique(page_ids->begin(), page_ids->end()), page_ids->end());
+  std::vector<Page *> pages(page_ids->size(), nullptr);
+  std::vector<frame_id_t> misses;
+  std::unique_lock lock(latch_);
+  // 1.     Pin every page that is resident or already being read in, and install a frame for every miss. The frames of
+  //        the misses stay LOADING, so that concurrent fetches of those pages wait for this batch instead of reading.
+  for (size_t i = 0; i < page_ids->size(); ++i) {
+    const page_id_t page_id = (*page_ids)[i];
+    if (page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    frame_id_t frame_id;
+    bool found = false;
+    while (true) {
+      if (FindFrame(&lock, page_id, &frame_id, true)) {
+        found = true;
+        if (pages_[frame_id].pin_count_++ == 0) {
+          replacer_->Pin(frame_id);
+        }
+        break;
+      }
+      if (AcquireFrame(&frame_id)) {
+        found = true;
+        InstallPage(&lock, frame_id, page_id);
+        misses.push_back(frame_id);
+        break;
+      }
+      if (!WaitForWriteback(&lock)) {
+        break;
+      }
+    }
+    if (found) {
+      pages[i] = &pages_[frame_id];
+    }
+  }
+  // 2.     Read the misses with the latch released. They were installed in ascending page id order, which keeps the
+  //        reads as sequential as the batch allows. With an AsyncDiskManager they are all in flight at once.
+  if (!misses.empty()) {
+    lock.unlock();
+    std::vector<std::future<bool>> reads;
+    for (auto frame_id : misses) {
+      pages_[frame_id].ResetMemory();
+      if (async_disk_manager_ != nullptr) {
+        reads.push_back(async_disk_manager_->ReadPageAsync(pages_[frame_id].page_id_, pages_[frame_id].data_));
+      } else {
+        disk_manager_->ReadPage(pages_[frame_id].page_id_, pages_[frame_id].data_);
+      }
+    }
+    for (auto &read : reads) {
+      read.wait();
+    }
+    lock.lock();
+    for (auto frame_id : misses) {
+      frame_states_[frame_id] = FrameState::READY;
+      frame_cv_[frame_id].notify_all();
+    }
+  }
+  // 3.     Wait for the pages that other threads were reading in when they were pinned.
+  for (auto *page : pages) {
+    if (page != nullptr) {
+      const auto frame_id = static_cast<frame_id_t>(page - pages_);
+      frame_cv_[frame_id].wait(lock, [&] { return frame_states_[frame_id] == FrameState::READY; });
+    }
+  }
+  return pages;
+}
+
+Page *BufferPoolManagerInstance::FetchPageIfResident(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && TryPinResident(frame_id, page_id)) {
+    return &pages_[frame_id];
+  }
+  return nullptr;
+}
+
+Page *BufferPoolManagerInstance::FetchChildPage(Page *parent, size_t slot, page_id_t child_page_id) {
+  if (slot >= Page::SWIZZLE_SLOTS) {
+    return FetchPage(child_page_id);
+  }
+  Page::SwizzleTable *table = parent->swizzle_table_.load(std::memory_order_acquire);
+  if (table != nullptr) {
+    // Frames are never destroyed while the instance lives, so any pointer into pages_ is safe to try. Pointers into
+    // other instances of a parallel pool belong to pages that this instance does not own, and are ignored.
+    Page *child = table->children_[slot].load(std::memory_order_relaxed);
+    if (child >= pages_ && child < pages_ + capacity_ &&
+        TryPinResident(static_cast<frame_id_t>(child - pages_), child_page_id)) {
+      return child;
+    }
+  }
+  Page *child = FetchPage(child_page_id);
+  if (child != nullptr) {
+    parent->GetSwizzleTable()->children_[slot].store(child, std::memory_order_relaxed);
+  }
+  return child;
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] {
+      return prefetch_shutdown_ || !prefetch_queue_.empty() || !warmup_queue_.empty() || !warmup_order_.empty();
+    });
+    if (prefetch_shutdown_) {
+      return;
+    }
+    // Read-ahead for running queries goes before the warm-up, which nobody is waiting for.
+    if (!prefetch_queue_.empty() || !warmup_queue_.empty()) {
+      const bool warmup = prefetch_queue_.empty();
+      auto &queue = warmup ? warmup_queue_ : prefetch_queue_;
+      page_id_t page_id = queue.front();
+      queue.pop_front();
+      lock.unlock();
+      PrefetchPage(page_id, warmup);
+      lock.lock();
+      continue;
+    }
+    std::vector<page_id_t> order;
+    order.swap(warmup_order_);
+    lock.unlock();
+    // Touching a page that is still being read in would skip it.
+    if (async_disk_manager_ != nullptr) {
+      async_disk_manager_->WaitForAll();
+    }
+    for (auto page_id : order) {
+      if (FetchPageIfResident(page_id) != nullptr) {
+        UnpinPageImpl(page_id, false);
+      }
+    }
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPage(page_id_t page_id, bool free_frames_only) {
+  std::unique_lock lock(latch_);
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || page_table_.Find(page_id, &frame_id) || (free_frames_only && free_list_.empty()) ||
+      !AcquireFrame(&frame_id)) {
+    return;
+  }
+  // Same as a miss in FetchPageImpl, except that the page is unpinned again as soon as it is READY. Fetches that
+  // arrive in the meantime find the frame LOADING and wait for it instead of issuing a read of their own.
+  InstallPage(&lock, frame_id, page_id);
+  lock.unlock();
+  pages_[frame_id].ResetMemory();
+  auto finish = [this, frame_id](bool /* success: a failed read leaves the page zeroed */) {
+    std::scoped_lock guard(latch_);
+    frame_states_[frame_id] = FrameState::READY;
+    frame_cv_[frame_id].notify_all();
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  };
+  // Asynchronously, the prefetch thread moves on to the next page right away and the completion finishes the frame.
+  if (async_disk_manager_ != nullptr) {
+    async_disk_manager_->ReadPageAsync(page_id, pages_[frame_id].data_, finish);
+    return;
+  }
+  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+  finish(true);
+}
+
+void BufferPoolManagerInstance::StartBackgroundWriter(const BackgroundWriterOptions &options) {
+  StopBackgroundWriter();
+  {
+    std::scoped_lock guard(writer_latch_);
+    writer_shutdown_ = false;
+  }
+  writer_thread_ = std::thread(&BufferPoolManagerInstance::BackgroundWriterLoop, this, options);
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  {
+    std::scoped_lock guard(writer_latch_);
+    writer_shutdown_ = true;
+  }
+  writer_cv_.notify_all();
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+}
+
+void BufferPoolManagerInstance::BackgroundWriterLoop(BackgroundWriterOptions options) {
+  std::unique_lock lock(writer_latch_);
+  while (!writer_shutdown_) {
+    lock.unlock();
+    BackgroundWriteRound(options);
+    lock.lock();
+    writer_cv_.wait_for(lock, options.interval, [&] { return writer_shutdown_; });
+  }
+}
+
+size_t BufferPoolManagerInstance::BackgroundWriteRound(const BackgroundWriterOptions &options) {
+  std::vector<frame_id_t> batch;
+  {
+    std::scoped_lock guard(latch_);
+    size_t clean_frames = 0;
+    for (size_t i = 0; i < pool_size_; ++i) {
+      clean_frames += pages_[i].is_dirty_ ? 0 : 1;
+    }
+    if (static_cast<double>(clean_frames) >= options.target_clean_ratio * static_cast<double>(pool_size_)) {
+      return 0;
+    }
+    // Pick unpinned dirty pages, continuing where the previous round stopped. Nobody can modify an unpinned page, so
+    // its LSN can be checked right here. The dirty flag is cleared up front; a modification that sneaks in before the
+    // write sets it again on unpin.
+    for (size_t i = 0; i < pool_size_ && batch.size() < options.batch_size; ++i) {
+      auto frame_id = static_cast<frame_id_t>(writer_cursor_);
+      writer_cursor_ = (writer_cursor_ + 1) % pool_size_;
+      Page &page = pages_[frame_id];
+      if (frame_states_[frame_id] != FrameState::READY || !page.is_dirty_ || page.pin_count_ > 0 ||
+          frame_writeback_[frame_id] || !IsWalSafe(&page)) {
+        continue;
+      }
+      page.is_dirty_ = false;
+      frame_writeback_[frame_id] = true;
+      ++writeback_count_;
+      batch.push_back(frame_id);
+    }
+  }
+
+  if (batch.empty()) {
+    return 0;
+  }
+
+  // The frames stay in the replacer, so the writer does not count as an access, but they cannot be recycled until
+  // their writeback flag is cleared. Hits on them proceed as usual. Every page is copied into a staging buffer under
+  // its read latch, one page at a time, and the copies are written; the writer never holds a page latch while it waits
+  // for I/O or for another latch, which could deadlock with a thread that crabs from one of the pages to another. With
+  // an AsyncDiskManager the whole batch is in flight at once. Without one, it is written in page order, with one write
+  // per run of consecutive pages.
+  auto free_staging = [](char *buffer) { ::operator delete[](buffer, std::align_val_t{DIRECT_IO_ALIGNMENT}); };
+  std::unique_ptr<char[], decltype(free_staging)> staging(
+      static_cast<char *>(::operator new[](batch.size() * PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT})),
+      free_staging);
+  std::vector<bool> written(batch.size(), false);
+  std::vector<std::future<bool>> writes(batch.size());
+  std::vector<std::pair<page_id_t, size_t>> in_order;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    Page &page = pages_[batch[i]];
+    char *copy = staging.get() + i * PAGE_SIZE;
+    page.RLatch();
+    written[i] = IsWalSafe(&page);
+    if (written[i]) {
+      memcpy(copy, page.data_, PAGE_SIZE);
+    }
+    page.RUnlatch();
+    if (written[i] && async_disk_manager_ != nullptr) {
+      writes[i] = async_disk_manager_->WritePageAsync(page.page_id_, copy);
+    } else if (written[i]) {
+      in_order.emplace_back(page.page_id_, i);
+    }
+  }
+  std::sort(in_order.begin(), in_order.end());
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> data;
+  for (const auto &[page_id, i] : in_order) {
+    page_ids.push_back(page_id);
+    data.push_back(staging.get() + i * PAGE_SIZE);
+  }
+  const std::vector<bool> in_order_written = disk_manager_->WritePages(page_ids, data);
+  for (size_t k = 0; k < in_order.size(); ++k) {
+    written[in_order[k].second] = in_order_written[k];
+  }
+  size_t num_written = 0;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    Page &page = pages_[batch[i]];
+    if (writes[i].valid()) {
+      written[i] = writes[i].get();
+    }
+    num_written += written[i] ? 1 : 0;
+    std::scoped_lock guard(latch_);
+    if (!written[i]) {
+      page.is_dirty_ = true;
+    }
+    frame_writeback_[batch[i]] = false;
+    --writeback_count_;
+  }
+  writeback_cv_.notify_all();
+  return num_written;
+}
+
+bool BufferPoolManagerInstance::IsWalSafe(Page *page) {
+  return !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
+}
+
+bool BufferPoolManagerInstance::FindFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t *frame_id,
+                                          bool allow_loading) {
+  while (true) {
+    if (!page_table_.Find(page_id, frame_id)) {
+      return false;
+    }
+    Page &page = pages_[*frame_id];
+    if (page.page_id_ == page_id &&
+        (frame_states_[*frame_id] == FrameState::READY ||
+         (allow_loading && frame_states_[*frame_id] == FrameState::LOADING))) {
+      return true;
+    }
+    // Either page_id is the dirty page that is being written out of this frame, or page_id is being installed in
+    // this frame behind such a write. Wait for the frame to settle and look again.
+    frame_cv_[*frame_id].wait(*lock);
+  }
+}
+
+bool BufferPoolManagerInstance::TryPinResident(frame_id_t frame_id, page_id_t page_id) {
+  Page &page = pages_[frame_id];
+  int pin_count = page.pin_count_;
+  do {
+    if (pin_count == UNPINNABLE) {
+      return false;
+    }
+  } while (!page.pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // The pin keeps the frame from being claimed, so if it holds the page now, it keeps holding it.
+  if (page.page_id_ == page_id && frame_states_[frame_id] == FrameState::READY) {
+    if (pin_count == 0) {
+      replacer_->Pin(frame_id);
+    }
+    return true;
+  }
+  // The table entry was stale, or the page is still in flight. If ours was the only pin, AcquireFrame may have taken
+  // the frame out of the replacer and dropped it while we held it, so hand it back.
+  if (page.pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return false;
+}
+
+bool BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) {
+  int pin_count = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(pin_count, UNPINNABLE);
+}
+
+bool BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.back();
+    free_list_.pop_back();
+    return true;
+  }
+  // Frames that the background writer is writing out cannot be recycled yet. They are put back into the replacer,
+  // which is rare enough that counting it as an access does not matter. A victim that a hit has pinned in the
+  // meantime is simply dropped; the replacer gets it back when its pin count returns to zero.
+  std::vector<frame_id_t> skipped;
+  bool found = false;
+  while (replacer_->Victim(frame_id)) {
+    if (frame_writeback_[*frame_id]) {
+      skipped.push_back(*frame_id);
+      continue;
+    }
+    if (ClaimFrame(*frame_id)) {
+      found = true;
+      break;
+    }
+  }
+  for (auto skipped_frame_id : skipped) {
+    replacer_->Unpin(skipped_frame_id);
+  }
+  return found;
+}
+
+bool BufferPoolManagerInstance::WaitForWriteback(std::unique_lock<std::mutex> *lock) {
+  if (writeback_count_ == 0) {
+    return false;
+  }
+  writeback_cv_.wait(*lock);
+  return true;
+}
+
+void BufferPoolManagerInstance::InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                                            page_id_t page_id) {
+  Page &page = pages_[frame_id];
+  const page_id_t old_page_id = page.page_id_;
+  const bool write_back = old_page_id != INVALID_PAGE_ID && page.is_dirty_;
+  // The frame is marked as in flight before it becomes pinnable under the new page id, so that a hit that pins it
+  // from then on fails its READY check and waits for the read instead of returning the old content.
+  frame_states_[frame_id] = write_back ? FrameState::EVICTING : FrameState::LOADING;
+  if (old_page_id != INVALID_PAGE_ID && !write_back) {
+    page_table_.Erase(old_page_id);
+  }
+  replacer_->Pin(frame_id);
+  // Whatever the old page referenced through the frame is meaningless for the new one.
+  page.Unswizzle();
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  page.pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  if (write_back) {
+    // The old page stays in the page table until it is on disk, so that nobody reads a stale copy of it.
+    lock->unlock();
+    disk_manager_->WritePage(old_page_id, page.data_);
+    lock->lock();
+    page_table_.Erase(old_page_id);
+    frame_states_[frame_id] = FrameState::LOADING;
+    frame_cv_[frame_id].notify_all();
+  }
+}
+
+void BufferPoolManagerInstance::Grow(size_t pool_size) {
+  arena_.Commit(pool_size);
+  page_table_.Reserve(2 * pool_size);
+  for (size_t i = pool_size_; i < pool_size; ++i) {
+    if (i < num_constructed_) {
+      // A frame retired by an earlier shrink. Its data was released, but its Page is still UNPINNABLE.
+      pages_[i].ResetMemory();
+    } else {
+      new (&pages_[i]) Page(arena_.GetFrameData(i));
+      pages_[i].pin_count_ = UNPINNABLE;
+      ++num_constructed_;
+    }
+    if (frame_cv_.size() <= i) {
+      frame_cv_.emplace_back();
+    }
+    frame_states_[i] = FrameState::FREE;
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+  frame_writeback_.resize(pool_size, false);
+  replacer_->Resize(pool_size);
+  pool_size_ = pool_size;
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage(page_id_t near_page_id) {
+  const page_id_t page_id = disk_manager_->AllocatePage(near_page_id, num_instances_, instance_index_);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
+
+}  // namespace bustub
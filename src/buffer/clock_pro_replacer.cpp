@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.cpp
+//
+// Identification: src/buffer/clock_pro_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_pro_replacer.h"
+
+#include <cassert>
+
+namespace bustub {
+
+ClockProReplacer::ClockProReplacer(size_t num_pages) : num_pages_(num_pages), frames_(num_pages) { SetHotTarget(); }
+
+ClockProReplacer::~ClockProReplacer() = default;
+
+bool ClockProReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock guard(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  for (size_t steps = 0;; ++steps) {
+    // If every unpinned frame is hot, the cold hand cannot find a victim on its own. After one fruitless revolution,
+    // let the hot hand move along with it; it demotes the unpinned hot frames within two revolutions.
+    if (steps >= num_pages_) {
+      RunHandHot();
+    }
+    size_t frame = hand_cold_;
+    hand_cold_ = (hand_cold_ + 1) % num_pages_;
+    FrameMeta &meta = frames_[frame];
+    if (!meta.in_replacer_ || meta.hot_) {
+      continue;
+    }
+    if (meta.referenced_) {
+      meta.referenced_ = false;
+      if (meta.in_test_) {
+        // Re-referenced within its test period: the page has a short reuse distance, so it becomes hot.
+        meta.hot_ = true;
+        meta.in_test_ = false;
+        ++hot_count_;
+        while (hot_count_ > hot_target_) {
+          RunHandHot();
+        }
+      } else {
+        meta.in_test_ = true;
+      }
+      continue;
+    }
+    meta = FrameMeta{};
+    --size_;
+    *frame_id = static_cast<frame_id_t>(frame);
+    return true;
+  }
+}
+
+void ClockProReplacer::RunHandHot() {
+  FrameMeta &meta = frames_[hand_hot_];
+  hand_hot_ = (hand_hot_ + 1) % num_pages_;
+  if (meta.hot_) {
+    if (meta.referenced_) {
+      meta.referenced_ = false;
+    } else {
+      meta.hot_ = false;
+      --hot_count_;
+    }
+  } else {
+    meta.in_test_ = false;
+  }
+}
+
+void ClockProReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  assert(static_cast<size_t>(frame_id) < num_pages_);
+  if (frames_[frame_id].in_replacer_) {
+    frames_[frame_id].in_replacer_ = false;
+    --size_;
+  }
+}
+
+void ClockProReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  if (static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  FrameMeta &meta = frames_[frame_id];
+  if (meta.in_replacer_) {
+    return;
+  }
+  meta.in_replacer_ = true;
+  ++size_;
+  if (meta.new_page_) {
+    meta.new_page_ = false;
+  } else {
+    meta.referenced_ = true;
+  }
+}
+
+size_t ClockProReplacer::Size() {
+  std::scoped_lock guard(latch_);
+  return size_;
+}
+
+void ClockProReplacer::GetVictimOrder(std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock guard(latch_);
+  frame_ids->clear();
+  frame_ids->reserve(size_);
+  // An approximation: unreferenced cold frames go first, in cold hand order, then the referenced cold frames, which
+  // get another chance or are promoted, and finally the hot frames in hot hand order.
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < num_pages_; ++i) {
+      size_t frame = (hand_cold_ + i) % num_pages_;
+      const FrameMeta &meta = frames_[frame];
+      if (meta.in_replacer_ && !meta.hot_ && meta.referenced_ == referenced) {
+        frame_ids->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+  for (size_t i = 0; i < num_pages_; ++i) {
+    size_t frame = (hand_hot_ + i) % num_pages_;
+    if (frames_[frame].in_replacer_ && frames_[frame].hot_) {
+      frame_ids->push_back(static_cast<frame_id_t>(frame));
+    }
+  }
+}
+
+void ClockProReplacer::Resize(size_t num_pages) {
+  std::scoped_lock guard(latch_);
+  for (size_t frame = num_pages; frame < num_pages_; ++frame) {
+    size_ -= frames_[frame].in_replacer_ ? 1 : 0;
+    hot_count_ -= frames_[frame].hot_ ? 1 : 0;
+  }
+  frames_.resize(num_pages);
+  num_pages_ = num_pages;
+  hand_cold_ = hand_cold_ < num_pages_ ? hand_cold_ : 0;
+  hand_hot_ = hand_hot_ < num_pages_ ? hand_hot_ : 0;
+  // A smaller hot target is enforced lazily, by the next promotion in Victim.
+  SetHotTarget();
+}
+
+void ClockProReplacer::SetHotTarget() {
+  // Keep a quarter of the frames, and at least one, for cold pages.
+  size_t cold_target = num_pages_ / 4 > 0 ? num_pages_ / 4 : 1;
+  hot_target_ = num_pages_ > cold_target ? num_pages_ - cold_target : 0;
+}
+
+}  // namespace bustub
@@ -12,18 +12,91 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <cassert>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), in_replacer_(num_pages, false), ref_bits_(num_pages, false) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock guard(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // Every frame in the replacer has its reference bit cleared within one revolution, so this ends within two.
+  while (true) {
+    size_t frame = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % num_pages_;
+    if (!in_replacer_[frame]) {
+      continue;
+    }
+    if (ref_bits_[frame]) {
+      ref_bits_[frame] = false;
+      continue;
+    }
+    in_replacer_[frame] = false;
+    --size_;
+    *frame_id = static_cast<frame_id_t>(frame);
+    return true;
+  }
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  assert(static_cast<size_t>(frame_id) < num_pages_);
+  if (in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = false;
+    --size_;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  if (static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if (!in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = true;
+    ref_bits_[frame_id] = true;
+    ++size_;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+size_t ClockReplacer::Size() {
+  std::scoped_lock guard(latch_);
+  return size_;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::GetVictimOrder(std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock guard(latch_);
+  frame_ids->clear();
+  frame_ids->reserve(size_);
+  // The hand takes the unreferenced frames in its first revolution, clearing the bits of the others as it passes them,
+  // and takes those in its second.
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < num_pages_; ++i) {
+      size_t frame = (clock_hand_ + i) % num_pages_;
+      if (in_replacer_[frame] && ref_bits_[frame] == referenced) {
+        frame_ids->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::Resize(size_t num_pages) {
+  std::scoped_lock guard(latch_);
+  for (size_t frame = num_pages; frame < num_pages_; ++frame) {
+    size_ -= in_replacer_[frame] ? 1 : 0;
+  }
+  in_replacer_.resize(num_pages, false);
+  ref_bits_.resize(num_pages, false);
+  num_pages_ = num_pages;
+  if (clock_hand_ >= num_pages_) {
+    clock_hand_ = 0;
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.cpp
+//
+// Identification: src/buffer/concurrent_page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/concurrent_page_table.h"
+
+#include <memory>
+#include <utility>
+
+namespace bustub {
+
+ConcurrentPageTable::ConcurrentPageTable(size_t max_entries) {
+  tables_.push_back(std::make_unique<Slots>(max_entries));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+ConcurrentPageTable::Slots::Slots(size_t max_entries) {
+  // Keep the load factor at or below one half, so that probe sequences stay short.
+  int log_slots = 1;
+  while ((static_cast<size_t>(1) << log_slots) < 2 * max_entries) {
+    ++log_slots;
+  }
+  const size_t num_slots = static_cast<size_t>(1) << log_slots;
+  mask_ = num_slots - 1;
+  shift_ = 64 - log_slots;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; ++i) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+void ConcurrentPageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(KeyOf(MakeEntry(page_id, frame_id)) == page_id && ValueOf(MakeEntry(page_id, frame_id)) == frame_id,
+                "The page id or frame id does not fit into a slot.");
+  Slots *table = tables_.back().get();
+  size_t slot = table->HomeSlot(page_id);
+  for (;; slot = (slot + 1) & table->mask_) {
+    const uint64_t entry = table->slots_[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      ++size_;
+      BUSTUB_ASSERT(size_ <= table->mask_, "The page table is full.");
+      break;
+    }
+    if (KeyOf(entry) == page_id) {
+      break;
+    }
+  }
+  table->slots_[slot].store(MakeEntry(page_id, frame_id), std::memory_order_release);
+}
+
+bool ConcurrentPageTable::Erase(page_id_t page_id) {
+  Slots *table = tables_.back().get();
+  const size_t mask = table->mask_;
+  auto &slots = table->slots_;
+  size_t hole = table->HomeSlot(page_id);
+  for (;; hole = (hole + 1) & mask) {
+    const uint64_t entry = slots[hole].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      return false;
+    }
+    if (KeyOf(entry) == page_id) {
+      break;
+    }
+  }
+  // Backward shift deletion: move every later entry of the cluster whose home slot is not in (hole, slot] into the
+  // hole, so that no probe sequence is interrupted and no tombstones pile up. Each entry is copied before its old slot
+  // is overwritten.
+  for (size_t slot = (hole + 1) & mask;; slot = (slot + 1) & mask) {
+    const uint64_t entry = slots[slot].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      break;
+    }
+    const size_t home = table->HomeSlot(KeyOf(entry));
+    const bool stays = hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!stays) {
+      slots[hole].store(entry, std::memory_order_release);
+      hole = slot;
+    }
+  }
+  slots[hole].store(EMPTY, std::memory_order_release);
+  --size_;
+  return true;
+}
+
+void ConcurrentPageTable::Reserve(size_t max_entries) {
+  const Slots *old_table = tables_.back().get();
+  if (2 * max_entries <= old_table->mask_ + 1) {
+    return;
+  }
+  // The new array is filled before it is published, so a Find sees either array complete.
+  auto table = std::make_unique<Slots>(max_entries);
+  for (size_t i = 0; i <= old_table->mask_; ++i) {
+    const uint64_t entry = old_table->slots_[i].load(std::memory_order_relaxed);
+    if (entry == EMPTY) {
+      continue;
+    }
+    size_t slot = table->HomeSlot(KeyOf(entry));
+    while (table->slots_[slot].load(std::memory_order_relaxed) != EMPTY) {
+      slot = (slot + 1) & table->mask_;
+    }
+    table->slots_[slot].store(entry, std::memory_order_relaxed);
+  }
+  table_.store(table.get(), std::memory_order_release);
+  tables_.push_back(std::move(table));
+}
+
+}  // namespace bustub
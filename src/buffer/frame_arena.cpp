@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace bustub {
+
+namespace {
+
+/** MPOL_PREFERRED from <numaif.h>, which is only shipped with libnuma. */
+constexpr int MPOL_PREFERRED_MODE = 1;
+
+size_t RoundUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+}  // namespace
+
+FrameArena::FrameArena(size_t capacity, const FrameArenaOptions &options)
+    : capacity_(capacity),
+      data_size_(RoundUp(capacity * FRAME_SIZE, HUGE_PAGE_SIZE)),
+      explicit_huge_pages_(options.huge_pages == HugePageMode::EXPLICIT),
+      numa_node_(options.numa_node) {
+  // Over-reserve by one huge page so that the frames can start on a huge page boundary.
+  mapping_size_ = data_size_ + HUGE_PAGE_SIZE;
+  void *mapping =
+      mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  BUSTUB_ASSERT(mapping != MAP_FAILED, "Couldn't reserve memory for the buffer pool frames.");
+  base_ = static_cast<char *>(mapping);
+  data_ = reinterpret_cast<char *>(RoundUp(reinterpret_cast<uintptr_t>(base_), HUGE_PAGE_SIZE));
+  // madvise is only a hint; kernels without transparent huge pages reject it, and that is fine.
+  madvise(data_, data_size_, options.huge_pages == HugePageMode::NONE ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+  BindToNode(0, data_size_);
+}
+
+FrameArena::~FrameArena() { munmap(base_, mapping_size_); }
+
+/**
+ * Without MAP_NORESERVE the huge pages are reserved right here, so a hugetlbfs pool that is too small fails now
+ * instead of with a SIGBUS on first touch
+ */
+void FrameArena::Commit(size_t end) {
+  const size_t size = RoundUp(end * FRAME_SIZE, HUGE_PAGE_SIZE);
+  if (!explicit_huge_pages_ || size <= huge_size_) {
+    return;
+  }
+  void *mapping = mmap(data_ + huge_size_, size - huge_size_, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_FIXED, -1, 0);
+  if (mapping == MAP_FAILED) {
+    // A failed MAP_FIXED may have unmapped part of the range, so map it again, for good this time.
+    explicit_huge_pages_ = false;
+    MapRegular(huge_size_);
+    return;
+  }
+  BindToNode(huge_size_, size - huge_size_);
+  huge_size_ = size;
+}
+
+void FrameArena::Release(size_t begin) {
+  // Explicit huge pages are only returned to their pool by unmapping them.
+  const size_t huge_offset = RoundUp(begin * FRAME_SIZE, HUGE_PAGE_SIZE);
+  if (huge_offset < huge_size_) {
+    huge_size_ = huge_offset;
+    MapRegular(huge_offset);
+  }
+  const size_t offset = std::max(huge_size_, RoundUp(begin * FRAME_SIZE, static_cast<size_t>(sysconf(_SC_PAGESIZE))));
+  if (offset < data_size_) {
+    madvise(data_ + offset, data_size_ - offset, MADV_DONTNEED);
+  }
+}
+
+void FrameArena::MapRegular(size_t offset) {
+  void *mapping = mmap(data_ + offset, data_size_ - offset, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+  BUSTUB_ASSERT(mapping != MAP_FAILED, "Couldn't reserve memory for the buffer pool frames.");
+  madvise(data_ + offset, data_size_ - offset, MADV_HUGEPAGE);
+  BindToNode(offset, data_size_ - offset);
+}
+
+void FrameArena::BindToNode(size_t offset, size_t size) {
+  if (numa_node_ != FrameArenaOptions::NO_NUMA_NODE && numa_node_ < GetNumaNodeCount()) {
+    // Prefer the node, but let the kernel fall back to others when it runs out of memory. The policy applies to pages
+    // as they are touched, so it has to be set before the first frame is constructed.
+    const unsigned long nodemask = 1UL << static_cast<unsigned>(numa_node_);  // NOLINT
+    syscall(SYS_mbind, data_ + offset, size, MPOL_PREFERRED_MODE, &nodemask, sizeof(nodemask) * 8, 0);
+  }
+}
+
+int FrameArena::GetNumaNodeCount() {
+  // The file holds a range list such as "0" or "0-3"; the last number is the highest node.
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string nodes;
+  if (!(online >> nodes) || nodes.empty()) {
+    return 1;
+  }
+  const size_t last = nodes.find_last_of("-,");
+  return std::stoi(last == std::string::npos ? nodes : nodes.substr(last + 1)) + 1;
+}
+
+}  // namespace bustub
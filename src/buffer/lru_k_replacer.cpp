@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : num_pages_(num_pages),
+      k_(k),
+      correlated_period_(correlated_period),
+      history_(num_pages * k, 0),
+      history_size_(num_pages, 0),
+      last_reference_(num_pages, 0),
+      heap_index_(num_pages, NOT_IN_HEAP) {
+  assert(k_ > 0);
+  heap_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock guard(latch_);
+  if (heap_.empty()) {
+    return false;
+  }
+  size_t victim = heap_[0];
+  HeapRemove(victim);
+  // The next page in this frame starts with an empty history.
+  history_size_[victim] = 0;
+  *frame_id = static_cast<frame_id_t>(victim);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  assert(static_cast<size_t>(frame_id) < num_pages_);
+  if (heap_index_[frame_id] != NOT_IN_HEAP) {
+    HeapRemove(frame_id);
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock guard(latch_);
+  if (static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if (heap_index_[frame_id] != NOT_IN_HEAP) {
+    return;
+  }
+  RecordReference(frame_id);
+  HeapPush(frame_id);
+}
+
+void LRUKReplacer::RecordReference(size_t frame_id) {
+  uint64_t now = ++current_timestamp_;
+  uint64_t *history = &history_[frame_id * k_];
+  size_t &history_size = history_size_[frame_id];
+  if (history_size > 0 && now - last_reference_[frame_id] <= correlated_period_) {
+    // A correlated reference only extends the current reference period.
+    last_reference_[frame_id] = now;
+    return;
+  }
+  // A new uncorrelated reference. The previous reference period is collapsed to a point by shifting the older history
+  // forward by its length, so that correlated bursts do not look like a long gap.
+  uint64_t correlated_span = history_size > 0 ? last_reference_[frame_id] - history[0] : 0;
+  if (history_size < k_) {
+    ++history_size;
+  }
+  for (size_t i = history_size - 1; i > 0; --i) {
+    history[i] = history[i - 1] + correlated_span;
+  }
+  history[0] = now;
+  last_reference_[frame_id] = now;
+}
+
+bool LRUKReplacer::EvictsBefore(size_t a, size_t b) const {
+  // Frames with fewer than k references (infinite backward k-distance) go first. Within either group, the frame whose
+  // oldest remembered reference is the oldest has the largest backward distance.
+  bool a_infinite = history_size_[a] < k_;
+  bool b_infinite = history_size_[b] < k_;
+  if (a_infinite != b_infinite) {
+    return a_infinite;
+  }
+  return history_[a * k_ + history_size_[a] - 1] < history_[b * k_ + history_size_[b] - 1];
+}
+
+void LRUKReplacer::HeapPush(size_t frame_id) {
+  heap_index_[frame_id] = heap_.size();
+  heap_.push_back(frame_id);
+  HeapFix(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapRemove(size_t frame_id) {
+  size_t i = heap_index_[frame_id];
+  HeapSwap(i, heap_.size() - 1);
+  heap_.pop_back();
+  heap_index_[frame_id] = NOT_IN_HEAP;
+  if (i < heap_.size()) {
+    HeapFix(i);
+  }
+}
+
+void LRUKReplacer::HeapSwap(size_t i, size_t j) {
+  std::swap(heap_[i], heap_[j]);
+  heap_index_[heap_[i]] = i;
+  heap_index_[heap_[j]] = j;
+}
+
+void LRUKReplacer::HeapFix(size_t i) {
+  while (i > 0 && EvictsBefore(heap_[i], heap_[(i - 1) / 2])) {
+    HeapSwap(i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+  while (true) {
+    size_t first = i;
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap_.size(); ++child) {
+      if (EvictsBefore(heap_[child], heap_[first])) {
+        first = child;
+      }
+    }
+    if (first == i) {
+      return;
+    }
+    HeapSwap(i, first);
+    i = first;
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock guard(latch_);
+  return heap_.size();
+}
+
+void LRUKReplacer::GetVictimOrder(std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock guard(latch_);
+  std::vector<size_t> frames(heap_);
+  std::sort(frames.begin(), frames.end(), [&](size_t a, size_t b) { return EvictsBefore(a, b); });
+  frame_ids->assign(frames.begin(), frames.end());
+}
+
+void LRUKReplacer::Resize(size_t num_pages) {
+  std::scoped_lock guard(latch_);
+  for (size_t frame = num_pages; frame < num_pages_; ++frame) {
+    if (heap_index_[frame] != NOT_IN_HEAP) {
+      HeapRemove(frame);
+    }
+  }
+  history_.resize(num_pages * k_, 0);
+  history_size_.resize(num_pages, 0);
+  last_reference_.resize(num_pages, 0);
+  heap_index_.resize(num_pages, NOT_IN_HEAP);
+  num_pages_ = num_pages;
+}
+
+}  // namespace bustub
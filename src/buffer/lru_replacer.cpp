@@ -39,6 +39,9 @@ void LRUReplacer::Pin(frame_id_t frame_id) {
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
   std::scoped_lock guard(latch_);
+  if (static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
   if (hash_table_.find(frame_id) == hash_table_.end()) {
     list_.emplace_back(frame_id);
     hash_table_[frame_id] = std::prev(list_.end());
@@ -51,4 +54,22 @@ size_t LRUReplacer::Size() {
   return list_.size();
 }
 
+void LRUReplacer::GetVictimOrder(std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock guard(latch_);
+  frame_ids->assign(list_.begin(), list_.end());
+}
+
+void LRUReplacer::Resize(size_t num_pages) {
+  std::scoped_lock guard(latch_);
+  for (auto it = list_.begin(); it != list_.end();) {
+    if (static_cast<size_t>(*it) >= num_pages) {
+      hash_table_.erase(*it);
+      it = list_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  num_pages_ = num_pages;
+}
+
 }  // namespace bustub
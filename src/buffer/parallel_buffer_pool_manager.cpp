@@ -0,0 +1,225 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     LogManager *log_manager, ReplacementPolicy policy,
+                                                     const FrameArenaOptions &arena_options)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance.");
+  const int num_numa_nodes = arena_options.numa_local_instances ? FrameArena::GetNumaNodeCount() : 1;
+  // Allocate and create individual BufferPoolManagerInstances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    FrameArenaOptions instance_arena_options = arena_options;
+    if (arena_options.numa_local_instances) {
+      instance_arena_options.numa_node = static_cast<int>(i % num_numa_nodes);
+    }
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, log_manager, policy,
+        instance_arena_options));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    return false;
+  }
+  bool resized = true;
+  for (size_t i = 0; i < num_instances; ++i) {
+    resized = instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0)) && resized;
+  }
+  return resized;
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> page_ids_per_instance(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    page_ids_per_instance[page_id % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->PrefetchPages(page_ids_per_instance[i]);
+  }
+}
+
+std::vector<Page *> ParallelBufferPoolManager::FetchPages(std::vector<page_id_t> *page_ids) {
+  std::sort(page_ids->begin(), page_ids->end());
+  page_ids->erase(std::unique(page_ids->begin(), page_ids->end()), page_ids->end());
+  std::vector<std::vector<page_id_t>> page_ids_per_instance(instances_.size());
+  for (auto page_id : *page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      page_ids_per_instance[page_id % instances_.size()].push_back(page_id);
+    }
+  }
+  std::vector<std::vector<Page *>> pages_per_instance(instances_.size());
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!page_ids_per_instance[i].empty()) {
+      pages_per_instance[i] = instances_[i]->FetchPages(&page_ids_per_instance[i]);
+    }
+  }
+  // Every instance returns its share in ascending order, so the shares can be merged back with one cursor each.
+  std::vector<Page *> pages;
+  pages.reserve(page_ids->size());
+  std::vector<size_t> cursors(instances_.size(), 0);
+  for (auto page_id : *page_ids) {
+    if (page_id == INVALID_PAGE_ID) {
+      pages.push_back(nullptr);
+      continue;
+    }
+    size_t i = page_id % instances_.size();
+    pages.push_back(pages_per_instance[i][cursors[i]++]);
+  }
+  return pages;
+}
+
+Page *ParallelBufferPoolManager::FetchPageIfResident(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchPageIfResident(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchChildPage(Page *parent, size_t slot, page_id_t child_page_id) {
+  return GetBufferPoolManager(child_page_id)->FetchChildPage(parent, slot, child_page_id);
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(const BackgroundWriterOptions &options) {
+  for (auto &instance : instances_) {
+    instance->StartBackgroundWriter(options);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+bool ParallelBufferPoolManager::SaveSnapshot() {
+  // Every instance only warms up its own pages, so the order between instances does not matter.
+  std::vector<page_id_t> page_ids;
+  for (auto &instance : instances_) {
+    std::vector<page_id_t> resident = instance->GetResidentPages();
+    page_ids.insert(page_ids.end(), resident.begin(), resident.end());
+  }
+  return disk_manager_->WriteSnapshot(page_ids);
+}
+
+bool ParallelBufferPoolManager::LoadSnapshot() {
+  std::vector<page_id_t> page_ids;
+  if (!disk_manager_->ReadSnapshot(&page_ids)) {
+    return false;
+  }
+  for (auto &instance : instances_) {
+    instance->WarmUp(page_ids);
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) {
+  for (auto &instance : instances_) {
+    instance->SetAsyncDiskManager(async_disk_manager);
+  }
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Get BufferPoolManager responsible for handling given page id.
+  return instances_[page_id % instances_.size()].get();
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  // Fetch page for page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Unpin page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  // 1.   From a starting index of the instances, call NewPage until either 1) success and return 2) looped around to
+  //      the starting index and return nullptr.
+  // 2.   Bump the starting index so that the next call starts its search at a different instance.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+Page *ParallelBufferPoolManager::NewPageNearImpl(page_id_t *page_id, page_id_t near_page_id) {
+  if (near_page_id == INVALID_PAGE_ID) {
+    return NewPageImpl(page_id);
+  }
+  const size_t num_instances = instances_.size();
+  const size_t start = static_cast<size_t>(near_page_id + 1) % num_instances;
+  for (size_t i = 0; i < num_instances; ++i) {
+    Page *page = instances_[(start + i) % num_instances]->NewPageNear(page_id, near_page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManagerInstance
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // Consecutive pages belong to different instances, so the dirty pages of all instances are written as one batch,
+  // which keeps their runs together, and synced once.
+  std::vector<std::vector<Page *>> pages(instances_.size());
+  std::vector<Page *> all_pages;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->PinDirtyPages(&pages[i]);
+    all_pages.insert(all_pages.end(), pages[i].begin(), pages[i].end());
+  }
+  const std::vector<Page *> failed = BufferPoolManagerInstance::WritePagesInOrder(disk_manager_, std::move(all_pages));
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->UnpinFlushedPages(pages[i], failed);
+  }
+  disk_manager_->SyncDataFile();
+}
+
+}  // namespace bustub
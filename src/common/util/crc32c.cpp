@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define BUSTUB_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32) && defined(__aarch64__)
+#include <arm_acle.h>
+#define BUSTUB_CRC32C_ARMV8 1
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The reflected CRC-32C polynomial. */
+constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+
+/**
+ * Slicing-by-8 tables: TABLES[0] advances the CRC by one byte, and TABLES[k][b] is the CRC of byte b followed by k
+ * zero bytes, so that eight table lookups advance it by eight bytes at once.
+ */
+struct Tables {
+  std::array<std::array<uint32_t, 256>, 8> table_;
+
+  constexpr Tables() : table_() {
+    for (uint32_t b = 0; b < 256; ++b) {
+      uint32_t crc = b;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+      }
+      table_[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+      for (size_t k = 1; k < 8; ++k) {
+        table_[k][b] = (table_[k - 1][b] >> 8) ^ table_[0][table_[k - 1][b] & 0xFF];
+      }
+    }
+  }
+};
+
+constexpr Tables TABLES;
+
+uint64_t LoadLittleEndian64(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+}  // namespace
+
+uint32_t Crc32c::ExtendPortable(uint32_t crc, const char *data, size_t length) {
+  const auto &t = TABLES.table_;
+  crc = ~crc;
+  for (; length >= 8; data += 8, length -= 8) {
+    const uint64_t word = LoadLittleEndian64(data) ^ crc;
+    crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF] ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF] ^
+          t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF] ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+  }
+  for (; length > 0; ++data, --length) {
+    crc = (crc >> 8) ^ t[0][(crc ^ static_cast<uint8_t>(*data)) & 0xFF];
+  }
+  return ~crc;
+}
+
+#if BUSTUB_CRC32C_SSE42
+
+uint32_t Crc32c::Extend(uint32_t crc, const char *data, size_t length) {
+  uint64_t crc64 = ~crc;
+  for (; length >= 8; data += 8, length -= 8) {
+    crc64 = _mm_crc32_u64(crc64, LoadLittleEndian64(data));
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; length > 0; ++data, --length) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+
+bool Crc32c::IsHardwareAccelerated() { return true; }
+
+#elif BUSTUB_CRC32C_ARMV8
+
+uint32_t Crc32c::Extend(uint32_t crc, const char *data, size_t length) {
+  crc = ~crc;
+  for (; length >= 8; data += 8, length -= 8) {
+    crc = __crc32cd(crc, LoadLittleEndian64(data));
+  }
+  for (; length > 0; ++data, --length) {
+    crc = __crc32cb(crc, static_cast<uint8_t>(*data));
+  }
+  return ~crc;
+}
+
+bool Crc32c::IsHardwareAccelerated() { return true; }
+
+#else
+
+uint32_t Crc32c::Extend(uint32_t crc, const char *data, size_t length) { return ExtendPortable(crc, data, length); }
+
+bool Crc32c::IsHardwareAccelerated() { return false; }
+
+#endif
+
+}  // namespace bustub
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.cpp
+//
+// Identification: src/common/util/lz4.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+/** The shortest match that a sequence can encode. */
+constexpr size_t MIN_MATCH = 4;
+/** The format requires the last five bytes to be literals... */
+constexpr size_t LAST_LITERALS = 5;
+/** ...and the last match to start at least twelve bytes before the end. */
+constexpr size_t MF_LIMIT = 12;
+/** The farthest back that a match may reach. */
+constexpr size_t MAX_DISTANCE = 65535;
+/** log2 of the number of entries of the compressor's hash table. */
+constexpr int HASH_LOG = 12;
+/** A length nibble of 15 is continued by bytes of 255 and one final byte below that. */
+constexpr size_t RUN_MASK = 15;
+
+uint32_t Read32(const char *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_LOG); }
+
+/** @return the number of bytes that encode the continuation of a length whose nibble is 15 */
+size_t ContinuationBytes(size_t length) { return length >= RUN_MASK ? (length - RUN_MASK) / 255 + 1 : 0; }
+
+char *WriteContinuation(char *op, size_t length) {
+  for (length -= RUN_MASK; length >= 255; length -= 255) {
+    *op++ = static_cast<char>(255);
+  }
+  *op++ = static_cast<char>(length);
+  return op;
+}
+
+/**
+ * Appends a sequence: the literals [anchor, anchor + literals), then a match of match_length bytes at distance
+ * offset, or no match at all for the last sequence (match_length 0).
+ * @return the new end of the output, or nullptr if the sequence would not fit before op_end
+ */
+char *WriteSequence(char *op, char *op_end, const char *anchor, size_t literals, size_t offset,
+                    size_t match_length) {
+  const size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  const size_t needed = 1 + ContinuationBytes(literals) + literals +
+                        (match_length == 0 ? 0 : 2 + ContinuationBytes(match_code));
+  if (static_cast<size_t>(op_end - op) < needed) {
+    return nullptr;
+  }
+  char *token = op++;
+  *token = static_cast<char>(std::min(literals, RUN_MASK) << 4);
+  if (literals >= RUN_MASK) {
+    op = WriteContinuation(op, literals);
+  }
+  memcpy(op, anchor, literals);
+  op += literals;
+  if (match_length == 0) {
+    return op;
+  }
+  *op++ = static_cast<char>(offset & 0xFF);
+  *op++ = static_cast<char>(offset >> 8);
+  *token = static_cast<char>(*token | std::min(match_code, RUN_MASK));
+  if (match_code >= RUN_MASK) {
+    op = WriteContinuation(op, match_code);
+  }
+  return op;
+}
+
+/** Reads the continuation of a length whose nibble is 15. @return false if the block ends first */
+bool ReadContinuation(const uint8_t **ip, const uint8_t *ip_end, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= ip_end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t Lz4::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  char *op = dst;
+  char *const op_end = dst + dst_capacity;
+  size_t anchor = 0;
+  if (src_size > MF_LIMIT) {
+    // Positions of the last occurrence of each hashed four-byte sequence. A stale or colliding entry is harmless,
+    // since every candidate is compared before it is used.
+    std::vector<uint32_t> table(size_t{1} << HASH_LOG, 0);
+    const size_t match_limit = src_size - MF_LIMIT;
+    const size_t match_end_limit = src_size - LAST_LITERALS;
+    size_t ip = 1;
+    while (ip < match_limit) {
+      const uint32_t sequence = Read32(src + ip);
+      const uint32_t h = Hash(sequence);
+      const size_t ref = table[h];
+      table[h] = static_cast<uint32_t>(ip);
+      if (ip - ref > MAX_DISTANCE || Read32(src + ref) != sequence) {
+        // Skip ahead faster the longer nothing matches, like the reference implementation does.
+        ip += 1 + ((ip - anchor) >> 6);
+        continue;
+      }
+      size_t length = MIN_MATCH;
+      while (ip + length < match_end_limit && src[ref + length] == src[ip + length]) {
+        ++length;
+      }
+      op = WriteSequence(op, op_end, src + anchor, ip - anchor, ip - ref, length);
+      if (op == nullptr) {
+        return 0;
+      }
+      ip += length;
+      anchor = ip;
+      if (ip - 2 < match_limit) {
+        table[Hash(Read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+      }
+    }
+  }
+  op = WriteSequence(op, op_end, src + anchor, src_size - anchor, 0, 0);
+  return op == nullptr ? 0 : static_cast<size_t>(op - dst);
+}
+
+bool Lz4::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const uint8_t *const ip_end = ip + src_size;
+  size_t op = 0;
+  while (ip < ip_end) {
+    const uint8_t token = *ip++;
+    size_t literals = token >> 4;
+    if (literals == RUN_MASK && !ReadContinuation(&ip, ip_end, &literals)) {
+      return false;
+    }
+    if (literals > static_cast<size_t>(ip_end - ip) || literals > dst_size - op) {
+      return false;
+    }
+    memcpy(dst + op, ip, literals);
+    ip += literals;
+    op += literals;
+    if (ip == ip_end) {
+      // The last sequence has no match.
+      return op == dst_size;
+    }
+    if (ip_end - ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t length = token & RUN_MASK;
+    if (length == RUN_MASK && !ReadContinuation(&ip, ip_end, &length)) {
+      return false;
+    }
+    length += MIN_MATCH;
+    if (offset == 0 || offset > op || length > dst_size - op) {
+      return false;
+    }
+    if (offset >= length) {
+      memcpy(dst + op, dst + op - offset, length);
+    } else {
+      // The match overlaps its own output, e.g. a run of one repeated byte; copy it front to back.
+      for (size_t i = 0; i < length; ++i) {
+        dst[op + i] = dst[op + i - offset];
+      }
+    }
+    op += length;
+  }
+  return false;
+}
+
+}  // namespace bustub
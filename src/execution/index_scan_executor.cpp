@@ -19,24 +19,40 @@ void IndexScanExecutor::Init() {
   table_meta_data_ = exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_);
   index_ = static_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info_->index_.get());
   cur_index_iter_ = index_->GetBeginIterator();
+  batch_rids_.clear();
+  batch_tuples_.clear();
+  batch_cursor_ = 0;
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
-  for (; cur_index_iter_ != index_->GetEndIterator(); ++cur_index_iter_) {
-    *rid = (*cur_index_iter_).second;
-    if (!table_meta_data_->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction())) {
-      throw std::runtime_error("Failed to get tuple");
-    }
-    *tuple = GenerateOutputTuple(*tuple);
+  while (batch_cursor_ < batch_rids_.size() || FetchBatch()) {
+    *rid = batch_rids_[batch_cursor_];
+    *tuple = GenerateOutputTuple(batch_tuples_[batch_cursor_]);
+    ++batch_cursor_;
     if (plan_->GetPredicate() == nullptr ||
         plan_->GetPredicate()->Evaluate(tuple, &table_meta_data_->schema_).GetAs<bool>()) {
-      ++cur_index_iter_;
       return true;
     }
   }
   return false;
 }
 
+bool IndexScanExecutor::FetchBatch() {
+  batch_rids_.clear();
+  batch_cursor_ = 0;
+  const auto batch_size = static_cast<size_t>(TUPLE_FETCH_BATCH_SIZE);
+  for (; cur_index_iter_ != index_->GetEndIterator() && batch_rids_.size() < batch_size; ++cur_index_iter_) {
+    batch_rids_.push_back((*cur_index_iter_).second);
+  }
+  if (batch_rids_.empty()) {
+    return false;
+  }
+  if (!table_meta_data_->table_->GetTuples(batch_rids_, &batch_tuples_, exec_ctx_->GetTransaction())) {
+    throw std::runtime_error("Failed to get tuple");
+  }
+  return true;
+}
+
 Tuple IndexScanExecutor::GenerateOutputTuple(const Tuple &tuple) {
   std::vector<Value> values;
   for (auto &col : GetOutputSchema()->GetColumns()) {
@@ -25,23 +25,45 @@ void NestIndexJoinExecutor::Init() {
   index_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexName(), inner_table_meta_data_->name_);
   assert(index_);
   child_executor_->Init();
+  left_tuples_.clear();
+  right_rids_.clear();
+  right_tuples_.clear();
+  batch_cursor_ = 0;
 }
 
 bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  if (batch_cursor_ == left_tuples_.size() && !FetchBatch()) {
+    return false;
+  }
+  *tuple = JoinTuple(&left_tuples_[batch_cursor_], &right_tuples_[batch_cursor_]);
+  ++batch_cursor_;
+  return true;
+}
+
+bool NestIndexJoinExecutor::FetchBatch() {
+  left_tuples_.clear();
+  right_rids_.clear();
+  batch_cursor_ = 0;
   Tuple left_tuple;
   RID tmp;
-  while (child_executor_->Next(&left_tuple, &tmp)) {
+  const auto batch_size = static_cast<size_t>(TUPLE_FETCH_BATCH_SIZE);
+  while (left_tuples_.size() < batch_size && child_executor_->Next(&left_tuple, &tmp)) {
     Tuple index_key = GenerateKeyTuple(left_tuple, index_->index_->GetKeySchema());
     std::vector<RID> result;
     index_->index_->ScanKey(index_key, &result, GetExecutorContext()->GetTransaction());
     if (!result.empty()) {
-      Tuple right_tuple;
-      inner_table_meta_data_->table_->GetTuple(result[0], &right_tuple, GetExecutorContext()->GetTransaction());
-      *tuple = JoinTuple(&left_tuple, &right_tuple);
-      return true;
+      left_tuples_.push_back(left_tuple);
+      right_rids_.push_back(result[0]);
     }
   }
-  return false;
+  if (left_tuples_.empty()) {
+    return false;
+  }
+  if (!inner_table_meta_data_->table_->GetTuples(right_rids_, &right_tuples_,
+                                                GetExecutorContext()->GetTransaction())) {
+    throw std::runtime_error("Failed to get tuple");
+  }
+  return true;
 }
 
 Tuple NestIndexJoinExecutor::GenerateKeyTuple(const Tuple &tuple, const Schema *key_schema) {
@@ -12,37 +12,58 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <chrono>  // NOLINT
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "common/config.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/async_disk_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Tuning knobs of the background writer, see BufferPoolManager::StartBackgroundWriter. */
+struct BackgroundWriterOptions {
+  /** How long the writer sleeps between rounds. */
+  std::chrono::milliseconds interval{100};
+  /** The maximum number of pages that one round writes back, per buffer pool instance. */
+  size_t batch_size{16};
+  /** The writer stays idle while at least this fraction of the frames is either free or clean. */
+  double target_clean_ratio{0.25};
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * This is the interface that the access methods (TableHeap, BPlusTree, the hash table) program against. It is
+ * implemented by BufferPoolManagerInstance, which owns a single pool of frames, and by ParallelBufferPoolManager,
+ * which shards pages across several instances.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
-  /**
-   * Creates a new BufferPoolManager.
-   * @param pool_size the size of the buffer pool
-   * @param disk_manager the disk manager
-   * @param log_manager the log manager (for testing only: nullptr = disable logging)
-   */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  /** The replacement policy that picks victim frames. */
+  enum class ReplacementPolicy {
+    /** Least recently used, see LRUReplacer. */
+    LRU,
+    /** LRU-K with correlated reference filtering, see LRUKReplacer. */
+    LRU_K,
+    /** Clock approximation of LRU, see ClockReplacer. */
+    CLOCK,
+    /** Scan-resistant CLOCK-Pro, see ClockProReplacer. */
+    CLOCK_PRO,
+  };
+
+  BufferPoolManager() = default;
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -91,11 +112,150 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
-  Page *GetPages() { return pages_; }
+  /**
+   * Fetches a page and wraps it in a guard that unpins it when the guard goes out of scope.
+   * @param page_id id of page to be fetched
+   * @return the guarded page; the guard is empty if the page could not be fetched
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id) { return {this, FetchPage(page_id)}; }
+
+  /**
+   * Fetches and read-latches a page. The guard releases the latch and then the pin.
+   * @param page_id id of page to be fetched
+   * @return the guarded page; the guard is empty if the page could not be fetched
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id) {
+    Page *page = FetchPage(page_id);
+    if (page != nullptr) {
+      page->RLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Fetches and write-latches a page. The guard releases the latch and then the pin.
+   * @param page_id id of page to be fetched
+   * @return the guarded page; the guard is empty if the page could not be fetched
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id) {
+    Page *page = FetchPage(page_id);
+    if (page != nullptr) {
+      page->WLatch();
+    }
+    return {this, page};
+  }
+
+  /**
+   * Creates a new page like NewPage, but asks the disk manager to place it close to a related page, so that pages that
+   * are read together, such as the pages of a table heap, end up contiguous on disk.
+   * @param[out] page_id id of created page
+   * @param near_page_id the related page, or INVALID_PAGE_ID for the behavior of NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageNear(page_id_t *page_id, page_id_t near_page_id) { return NewPageNearImpl(page_id, near_page_id); }
+
+  /**
+   * Creates a new page and wraps it in a guard. The new page is zeroed but not yet on disk, so the guard starts out
+   * dirty.
+   * @param[out] page_id id of created page
+   * @param near_page_id a related page to place the new page close to, see NewPageNear
+   * @return the guarded page; the guard is empty if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id, page_id_t near_page_id = INVALID_PAGE_ID) {
+    BasicPageGuard guard(this, near_page_id == INVALID_PAGE_ID ? NewPage(page_id) : NewPageNear(page_id, near_page_id));
+    if (guard.IsValid()) {
+      guard.MarkDirty();
+    }
+    return guard;
+  }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() = 0;
+
+  /**
+   * Grows or shrinks the buffer pool while it is in use. Growing adds free frames. Shrinking evicts the pages in the
+   * frames that go away, writing back the dirty ones, and fails if any of those frames is pinned or has I/O in flight.
+   * @param pool_size the new size of the buffer pool
+   * @return true if the pool now has pool_size frames
+   */
+  virtual bool Resize(size_t pool_size) = 0;
+
+  /**
+   * Asks the buffer pool to read the given pages in the background, so that later fetches of them are hits. This is
+   * only a hint: pages that are already resident, or for which no frame can be freed, are skipped. The pages are not
+   * pinned.
+   * @param page_ids ids of the pages to read ahead
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids) = 0;
+
+  /**
+   * Fetches several pages at once. The ids are sorted and deduplicated first, so every distinct page is pinned exactly
+   * once. Implementations take their latch once for the whole batch and read the misses in ascending page id order.
+   * @param[in,out] page_ids ids of the pages to fetch; sorted and deduplicated on return
+   * @return the pages in the order of page_ids, with nullptr for every page that could not be fetched. The caller
+   * unpins each page that is not nullptr once.
+   */
+  virtual std::vector<Page *> FetchPages(std::vector<page_id_t> *page_ids) = 0;
+
+  /**
+   * Pins and returns a page only if it is resident and its content is valid. Never reads from disk and never waits
+   * for in-flight I/O, which makes it suitable for opportunistic work such as following a chain of read-ahead pages.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not ready in the buffer pool
+   */
+  virtual Page *FetchPageIfResident(page_id_t page_id) = 0;
+
+  /**
+   * Fetches a child of a B+ tree internal page through a swizzled reference. Every parent frame keeps a table of the
+   * frames that its children were last found in. If the frame in the child's slot is still READY with child_page_id,
+   * it is pinned directly, without a page table lookup; otherwise this is a FetchPage that swizzles the slot. The
+   * references are hints that are validated on every use: a child that was evicted, or moved to another slot, is
+   * simply fetched again. The table of a frame is cleared when the frame is recycled.
+   * @param parent the pinned page that references the child
+   * @param slot the index of the child in the parent
+   * @param child_page_id id of the child
+   * @return the pinned child, or nullptr if it could not be fetched
+   */
+  virtual Page *FetchChildPage(Page *parent, size_t slot, page_id_t child_page_id) = 0;
+
+  /**
+   * Starts writing back unpinned dirty pages in the background, so that evictions find clean victims and foreground
+   * fetches do not have to wait for a write. If logging is enabled, a page is only written once its LSN is covered by
+   * LogManager::GetPersistentLSN(). Restarts the writer if it is already running.
+   * @param options interval, batch size and target clean ratio of the writer
+   */
+  virtual void StartBackgroundWriter(const BackgroundWriterOptions &options) = 0;
+
+  /** Stops the background writer and waits for its current round to finish. Does nothing if it is not running. */
+  virtual void StopBackgroundWriter() = 0;
+
+  /**
+   * Saves the ids of the resident pages to the snapshot file next to the database file, from which LoadSnapshot warms
+   * up the pool after a restart. The pages are listed in the order in which the replacer would evict them, pinned
+   * pages last. Only ids are saved; the pages are read back from the database file, so dirty pages that have not been
+   * flushed come back with their last flushed content, exactly as a cold fetch would see them.
+   * @return false if the snapshot could not be written
+   */
+  virtual bool SaveSnapshot() = 0;
+
+  /**
+   * Starts preloading the pages of the last snapshot in the background, in ascending page id order, and returns right
+   * away. Only free frames are used, so the warm-up never evicts pages that were fetched in the meantime. Once the
+   * pages are read, they are touched from the coldest to the hottest, which restores the replacer order of the snapshot
+   * as far as the replacement policy allows.
+   * @return false if there is no snapshot to load
+   */
+  virtual bool LoadSnapshot() = 0;
+
+  /**
+   * Lets the background and batch I/O of the pool go through an AsyncDiskManager on the same database file, so that
+   * it keeps many requests in flight instead of one at a time: read-ahead issues its reads without waiting for them,
+   * FetchPages reads all its misses at once, and the background writer writes a whole batch at once. Foreground
+   * fetches and evictions stay synchronous. Must be called before the pool is used concurrently; the AsyncDiskManager
+   * must outlive the pool.
+   * @param async_disk_manager the AsyncDiskManager to use, or nullptr for synchronous I/O only
+   */
+  virtual void SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) = 0;
 
  protected:
   /**
@@ -116,7 +276,7 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,49 +284,40 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty) = 0;
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id) = 0;
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id) = 0;
+
+  /**
+   * Creates a new page in the buffer pool, placed close to a related page on disk.
+   * @param[out] page_id id of created page
+   * @param near_page_id the related page, or INVALID_PAGE_ID
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageNearImpl(page_id_t *page_id, page_id_t near_page_id) = 0;
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id) = 0;
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
-
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
-  Page *pages_;
-  /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
-  /** List of free pages. */
-  std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  virtual void FlushAllPagesImpl() = 0;
 };
 }  // namespace bustub
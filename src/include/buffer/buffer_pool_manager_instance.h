@@ -0,0 +1,374 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_instance.h
+//
+// Identification: src/include/buffer/buffer_pool_manager_instance.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/concurrent_page_table.h"
+#include "buffer/frame_arena.h"
+#include "buffer/replacer.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolManagerInstance owns a single pool of frames, together with the page table and the replacer that manage
+ * them. Every instance hands out page ids from its own residue class (instance_index modulo num_instances), which is
+ * what lets ParallelBufferPoolManager route a page id back to the instance that owns it.
+ *
+ * The page data lives in a FrameArena, apart from the cache-line aligned Page book-keeping in pages_.
+ *
+ * Disk I/O is never performed while holding latch_. A frame whose content is in flight is marked LOADING or EVICTING;
+ * threads that need such a frame wait on that frame's condition variable, while hits on other frames proceed.
+ *
+ * Hits do not take latch_ at all. FetchPage looks the page up in the lock-free page table and pins the frame with a
+ * compare-and-swap on its pin count, then checks that the frame still holds the page. A frame is only recycled after
+ * its pin count is swapped from 0 to UNPINNABLE under latch_, so a frame that passes the check cannot be evicted
+ * until it is unpinned. UnpinPage is lock-free as well. latch_ is only needed for misses, evictions and deletions.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new stand-alone BufferPoolManagerInstance.
+   * @param pool_size the size of the buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy
+   * @param arena_options huge page and NUMA placement of the frames
+   */
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacementPolicy policy = ReplacementPolicy::LRU,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * Creates a new BufferPoolManagerInstance that is one shard of a parallel buffer pool.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy
+   * @param arena_options huge page and NUMA placement of the frames
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacementPolicy policy = ReplacementPolicy::LRU,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * Destroys an existing BufferPoolManagerInstance.
+   */
+  ~BufferPoolManagerInstance() override;
+
+  /** @return pointer to all the pages in the buffer pool */
+  Page *GetPages() { return pages_; }
+
+  /** @return size of the buffer pool */
+  size_t GetPoolSize() override { return pool_size_; }
+
+  /**
+   * Resizes the pool within the capacity that was reserved at construction, the larger of the initial pool size and
+   * FrameArenaOptions::max_pool_size frames. The frames stay at fixed addresses, so growing never moves a page that a
+   * caller holds. Shrinking removes the frames with the highest ids and returns the memory of their data to the
+   * operating system.
+   * @param pool_size the new size of the buffer pool, between 1 and the capacity
+   * @return false if pool_size is out of range or a frame that would be removed is in use
+   */
+  bool Resize(size_t pool_size) override;
+
+  /**
+   * Queues the pages for the background I/O thread of this instance, which is started on first use.
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Pins the resident pages and installs frames for all the misses under one acquisition of latch_, then reads the
+   * misses with the latch released. The latch is only dropped earlier if a victim has to be written back first.
+   * @param[in,out] page_ids ids of the pages to fetch; sorted and deduplicated on return
+   * @return the pages in the order of page_ids, nullptr where no frame was left
+   */
+  std::vector<Page *> FetchPages(std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * Like the hit path of FetchPage, so it never takes latch_. A page whose table entry is being moved may be missed.
+   */
+  Page *FetchPageIfResident(page_id_t page_id) override;
+
+  /** The swizzled path is the hit path of FetchPage without the page table lookup. */
+  Page *FetchChildPage(Page *parent, size_t slot, page_id_t child_page_id) override;
+
+  void StartBackgroundWriter(const BackgroundWriterOptions &options) override;
+
+  void StopBackgroundWriter() override;
+
+  bool SaveSnapshot() override;
+
+  bool LoadSnapshot() override;
+
+  void SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) override { async_disk_manager_ = async_disk_manager; }
+
+  /**
+   * Lists the pages that are resident and READY: the unpinned ones in the victim order of the replacer, followed by
+   * the pinned ones.
+   * @return ids of the resident pages, the next victim first
+   */
+  std::vector<page_id_t> GetResidentPages();
+
+  /**
+   * Queues the pages of a snapshot that belong to this instance for the background I/O thread, see LoadSnapshot. If
+   * there are more of them than frames, only the hottest are kept.
+   * @param page_ids ids of the pages, coldest first; pages of other instances are ignored
+   */
+  void WarmUp(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Pins the resident dirty pages and marks them clean, for a flush that writes them together with those of other
+   * instances. A modification that comes in before the write marks its page dirty again on unpin.
+   * @param[out] pages the pages to write, appended; each must be passed to UnpinFlushedPages after the write
+   */
+  void PinDirtyPages(std::vector<Page *> *pages);
+
+  /**
+   * Unpins the pages of PinDirtyPages once they are written, and marks the ones that failed to write dirty again.
+   * @param pages the pages of PinDirtyPages
+   * @param failed the pages that failed to write, see WritePagesInOrder; pages of other instances are ignored
+   */
+  void UnpinFlushedPages(const std::vector<Page *> &pages, const std::vector<Page *> &failed);
+
+  /**
+   * Writes pages in the order of their ids, so that the disk manager writes runs of consecutive pages at once.
+   * @param disk_manager the disk manager to write to
+   * @param pages the pages to write, which must not change until the call returns
+   * @return the pages that failed to write
+   */
+  static std::vector<Page *> WritePagesInOrder(DiskManager *disk_manager, std::vector<Page *> pages);
+
+ protected:
+  /** The pin count of a frame that holds no page that may be pinned: it is free, retired or being recycled. */
+  static constexpr int UNPINNABLE = -1;
+
+  /** The life cycle of a frame. Only READY frames may be handed out to callers. */
+  enum class FrameState {
+    /** The frame is on the free list. */
+    FREE,
+    /** A page is being read into the frame from disk. */
+    LOADING,
+    /** A page is resident and its content is valid. */
+    READY,
+    /** The dirty page that previously occupied the frame is being written back. */
+    EVICTING,
+  };
+
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  Page *NewPageNearImpl(page_id_t *page_id, page_id_t near_page_id) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+  /**
+   * Looks up a page in the page table, waiting out any in-flight I/O on its frame.
+   * @param lock the held lock on latch_, which is released while waiting
+   * @param page_id id of the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @param allow_loading if true, also return a frame into which the page is still being read
+   * @return true if the page is resident, false otherwise
+   */
+  bool FindFrame(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t *frame_id,
+                 bool allow_loading = false);
+
+  /**
+   * Pins a frame without latch_, provided that it holds the page and is READY.
+   * @param frame_id the frame that the page table maps the page to
+   * @param page_id the page that the caller expects in the frame
+   * @return true if the frame is pinned; false if the page has to be looked up again under latch_
+   */
+  bool TryPinResident(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Makes an unpinned frame UNPINNABLE, so that hits can no longer pin it. Requires latch_.
+   * @param frame_id the frame to claim
+   * @return false if the frame is pinned
+   */
+  bool ClaimFrame(frame_id_t frame_id);
+
+  /**
+   * Takes a frame from the free list, or failing that, a victim from the replacer that is not being written by the
+   * background writer. The frame is returned UNPINNABLE. Requires latch_.
+   * @param[out] frame_id the acquired frame
+   * @return false if every frame is pinned or being written
+   */
+  bool AcquireFrame(frame_id_t *frame_id);
+
+  /**
+   * Waits until the background writer finishes a batch, if it has one in flight.
+   * @param lock the held lock on latch_, which is released while waiting
+   * @return false if there was nothing to wait for
+   */
+  bool WaitForWriteback(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Points an acquired frame at a new page, pinned once, and leaves it LOADING. If the frame held a dirty page, that
+   * page is written back first with latch_ released.
+   * @param lock the held lock on latch_
+   * @param frame_id the frame returned by AcquireFrame
+   * @param page_id id of the page to install
+   */
+  void InstallPage(std::unique_lock<std::mutex> *lock, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Reads a page into a free or victim frame unless it is already resident, and leaves it unpinned.
+   * @param page_id id of the page to read
+   * @param free_frames_only if true, skip the page instead of evicting another one
+   */
+  void PrefetchPage(page_id_t page_id, bool free_frames_only = false);
+
+  /**
+   * The body of prefetch_thread_: serves prefetch_queue_, then warmup_queue_, then warmup_order_, until the instance is
+   * destroyed.
+   */
+  void PrefetchLoop();
+
+  /** The body of writer_thread_: runs a round of write-back every interval until the writer is stopped. */
+  void BackgroundWriterLoop(BackgroundWriterOptions options);
+
+  /**
+   * Writes back up to batch_size unpinned dirty pages if less than target_clean_ratio of the frames are free or clean.
+   * @return the number of pages written
+   */
+  size_t BackgroundWriteRound(const BackgroundWriterOptions &options);
+
+  /** @return true if logging allows the page to be written, i.e. its log records are already on disk */
+  bool IsWalSafe(Page *page);
+
+  /**
+   * Allocate a page id from this instance's residue class on disk.
+   * @param near_page_id a related page to place the new page close to, or INVALID_PAGE_ID
+   * @return the allocated page id
+   */
+  page_id_t AllocatePage(page_id_t near_page_id);
+
+  /**
+   * Asserts that a page id belongs to this instance.
+   * @param page_id the page id to check
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * Adds frames [pool_size_, pool_size) to the free list, constructing those that have never been used. Requires
+   * latch_.
+   * @param pool_size the new size of the buffer pool, at most capacity_
+   */
+  void Grow(size_t pool_size);
+
+  /** Number of pages in the buffer pool. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames for which address space is reserved at pages_. */
+  const size_t capacity_;
+  /** Number of instances in the parallel buffer pool that this instance belongs to. */
+  const uint32_t num_instances_;
+  /** Index of this instance in the parallel buffer pool. */
+  const uint32_t instance_index_;
+  /** The data of all frames; pages_[i] points at frame i of the arena. */
+  FrameArena arena_;
+  /**
+   * Array of buffer pool pages. The first num_constructed_ entries are constructed. Shrinking the pool leaves the
+   * removed Pages constructed and UNPINNABLE, so that a hit that still holds a stale frame id can safely look at them.
+   */
+  Page *pages_;
+  /** Number of constructed entries of pages_, at least pool_size_. */
+  size_t num_constructed_{0};
+  /** Pointer to the disk manager. */
+  DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager. */
+  LogManager *log_manager_ __attribute__((__unused__));
+  /** Issues read-ahead, batch fetch and background writer I/O if not nullptr, see SetAsyncDiskManager. */
+  AsyncDiskManager *async_disk_manager_{nullptr};
+  /**
+   * Page table for keeping track of buffer pool pages. Read without latch_ by hits, written under latch_. A frame can
+   * be in it under two page ids while it is EVICTING, so it is sized for twice the pool size, and grown with it.
+   */
+  ConcurrentPageTable page_table_;
+  /** Replacer to find unpinned pages for replacement. */
+  Replacer *replacer_;
+  /** List of free pages. */
+  std::list<frame_id_t> free_list_;
+  /** The state of every frame, capacity_ entries. Written under latch_, read by hits without it. */
+  std::unique_ptr<std::atomic<FrameState>[]> frame_states_;
+  /**
+   * One condition variable per frame, signalled whenever the frame leaves LOADING or EVICTING. A deque, so that growing
+   * does not move the ones that threads wait on; it never shrinks for the same reason.
+   */
+  std::deque<std::condition_variable> frame_cv_;
+  /** frame_writeback_[i] is true while the background writer writes frame i. Such a frame is not recycled. */
+  std::vector<bool> frame_writeback_;
+  /** Number of frames whose frame_writeback_ flag is set. */
+  size_t writeback_count_{0};
+  /** Signalled when the background writer finishes a batch. */
+  std::condition_variable writeback_cv_;
+  /**
+   * Serializes writers of page_table_ and frame_states_, and protects free_list_, frame_writeback_ and the recycling
+   * of frames.
+   */
+  std::mutex latch_;
+  /** Serializes calls to Resize, which releases latch_ while it writes back evicted pages. */
+  std::mutex resize_latch_;
+
+  /** Pages waiting to be read by prefetch_thread_. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Pages of a snapshot waiting to be read by prefetch_thread_ into free frames, in ascending order. */
+  std::deque<page_id_t> warmup_queue_;
+  /** Pages of a snapshot that prefetch_thread_ touches, coldest first, once warmup_queue_ is drained. */
+  std::vector<page_id_t> warmup_order_;
+  /** Background I/O thread for PrefetchPages, started lazily. */
+  std::thread prefetch_thread_;
+  /** Set by the destructor to stop prefetch_thread_. */
+  bool prefetch_shutdown_{false};
+  /** Signalled when prefetch_queue_ or warmup_queue_ grows or prefetch_shutdown_ is set. */
+  std::condition_variable prefetch_cv_;
+  /**
+   * Protects prefetch_queue_, warmup_queue_, warmup_order_, prefetch_thread_ and prefetch_shutdown_. Never held
+   * together with latch_.
+   */
+  std::mutex prefetch_latch_;
+
+  /** Background writer thread, see StartBackgroundWriter. */
+  std::thread writer_thread_;
+  /** Set to stop writer_thread_. */
+  bool writer_shutdown_{false};
+  /** Signalled when writer_shutdown_ is set. */
+  std::condition_variable writer_cv_;
+  /** Protects writer_shutdown_. Never held together with latch_. */
+  std::mutex writer_latch_;
+  /** The frame at which the next round of the background writer starts looking for dirty pages. Requires latch_. */
+  size_t writer_cursor_{0};
+};
+}  // namespace bustub
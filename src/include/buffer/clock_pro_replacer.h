@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer.h
+//
+// Identification: src/include/buffer/clock_pro_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ClockProReplacer implements a frame-only variant of the CLOCK-Pro replacement policy (Jiang, Chen and Zhang, 2005).
+ *
+ * Frames are either hot or cold. A page starts out cold and in its test period; only if it is referenced again before
+ * the cold hand comes around is it promoted to hot. Victims are always taken from the cold frames, and the hot hand
+ * demotes unreferenced hot frames whenever there are more hot frames than the hot target. A sequential scan therefore
+ * only ever cycles through the cold frames, and cannot flush out a hot working set.
+ *
+ * The replacer only sees frame ids, so unlike the original algorithm it keeps no history of non-resident pages, and the
+ * number of cold frames is a fixed fraction of the pool instead of adapting to the workload.
+ */
+class ClockProReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ClockProReplacer.
+   * @param num_pages the maximum number of pages the ClockProReplacer will be required to store
+   */
+  explicit ClockProReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ClockProReplacer.
+   */
+  ~ClockProReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void GetVictimOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  void Resize(size_t num_pages) override;
+
+ private:
+  struct FrameMeta {
+    /** The frame is unpinned and may be victimized. */
+    bool in_replacer_{false};
+    /** The frame has been unpinned since a hand last passed it. */
+    bool referenced_{false};
+    /** The frame holds a hot page. */
+    bool hot_{false};
+    /** The frame holds a cold page that is in its test period. */
+    bool in_test_{true};
+    /** The frame holds a page that has not been unpinned yet; its first unpin is not a re-reference. */
+    bool new_page_{true};
+  };
+
+  /** Advances the hot hand by one frame, demoting an unreferenced hot frame or ending a test period. */
+  void RunHandHot();
+
+  /** Derives hot_target_ from num_pages_. */
+  void SetHotTarget();
+
+  size_t num_pages_;
+  std::vector<FrameMeta> frames_;
+  /** Number of frames in the replacer. */
+  size_t size_{0};
+  /** Number of frames holding hot pages, pinned or not. */
+  size_t hot_count_{0};
+  /** The maximum number of hot frames. */
+  size_t hot_target_;
+  size_t hand_cold_{0};
+  size_t hand_hot_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
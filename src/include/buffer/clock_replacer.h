@@ -23,6 +23,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The frames form a circular buffer with a reference bit each; no memory is allocated after construction. Unpin sets
+ * the reference bit, and the clock hand clears set bits as it sweeps until it finds an unreferenced frame.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,8 +48,21 @@ class ClockReplacer : public Replacer {
 
   size_t Size() override;
 
+  void GetVictimOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  void Resize(size_t num_pages) override;
+
  private:
-  // TODO(student): implement me!
+  size_t num_pages_;
+  /** in_replacer_[i] is true if frame i is unpinned and may be victimized. */
+  std::vector<bool> in_replacer_;
+  /** ref_bits_[i] is true if frame i has been unpinned since the clock hand last passed it. */
+  std::vector<bool> ref_bits_;
+  /** Number of frames in the replacer. */
+  size_t size_{0};
+  /** The frame the clock hand points at. */
+  size_t clock_hand_{0};
+  std::mutex latch_;
 };
 
 }  // namespace bustub
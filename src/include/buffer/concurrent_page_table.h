@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.h
+//
+// Identification: src/include/buffer/concurrent_page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentPageTable maps page ids to frame ids with linear probing over a fixed array of atomic slots. Every slot
+ * packs a page id and a frame id into one 64-bit word, so a reader never sees half of an update. With 64-bit page ids
+ * (BUSTUB_PAGE_ID_64) the word holds 40 bits of page id and 24 bits of frame id instead of 32 bits each.
+ *
+ * Find is lock-free and may run concurrently with everything else. Insert and Erase must be serialized by the caller,
+ * which the buffer pool does with its latch. A concurrent Find sees every entry that was present for its whole
+ * duration, with one exception: Erase closes the gap it leaves by shifting later entries of the probe sequence
+ * backwards, and a Find that races with the shift may miss the entry that moves. Callers therefore treat a miss as a
+ * hint and look again under the writer lock. A hit may be stale as well, and has to be validated against the frame.
+ *
+ * Reserve grows the table by building a larger array and swapping it in. A Find that still probes the old array sees
+ * the entries as of the swap, which is no worse than the races above. Since nothing tells when the last such Find is
+ * done, old arrays are only freed with the table; growing by doubling, they take less memory than the current one.
+ */
+class ConcurrentPageTable {
+ public:
+  /**
+   * Creates an empty table.
+   * @param max_entries the maximum number of entries that will be in the table at the same time until Reserve
+   */
+  explicit ConcurrentPageTable(size_t max_entries);
+
+  ~ConcurrentPageTable() = default;
+
+  DISALLOW_COPY_AND_MOVE(ConcurrentPageTable);
+
+  /**
+   * Looks up a page without taking any lock.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const {
+    const Slots *table = table_.load(std::memory_order_acquire);
+    for (size_t slot = table->HomeSlot(page_id);; slot = (slot + 1) & table->mask_) {
+      const uint64_t entry = table->slots_[slot].load(std::memory_order_acquire);
+      if (entry == EMPTY) {
+        return false;
+      }
+      if (KeyOf(entry) == page_id) {
+        *frame_id = ValueOf(entry);
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Inserts a mapping, or updates it if the page is already in the table. Requires the writer lock.
+   * @param page_id the page
+   * @param frame_id the frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a mapping. Requires the writer lock.
+   * @param page_id the page to remove
+   * @return false if the page was not in the table
+   */
+  bool Erase(page_id_t page_id);
+
+  /**
+   * Grows the table, if needed, so that it can hold max_entries entries at the same time. Requires the writer lock.
+   * @param max_entries the new maximum number of entries
+   */
+  void Reserve(size_t max_entries);
+
+  /** @return the number of entries. Requires the writer lock. */
+  size_t Size() const { return size_; }
+
+ private:
+  /** Bits of a slot that hold the frame id; the page id takes the rest. */
+  static constexpr int FRAME_BITS = sizeof(page_id_t) == 4 ? 32 : 24;
+  static constexpr uint64_t FRAME_MASK = (uint64_t{1} << FRAME_BITS) - 1;
+  static constexpr uint64_t PAGE_MASK = ~uint64_t{0} >> FRAME_BITS;
+
+  /** The value of a slot that holds no entry: INVALID_PAGE_ID in both parts. */
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+  static uint64_t MakeEntry(page_id_t page_id, frame_id_t frame_id) {
+    return ((static_cast<uint64_t>(page_id) & PAGE_MASK) << FRAME_BITS) |
+           (static_cast<uint64_t>(frame_id) & FRAME_MASK);
+  }
+  /** Sign-extends the page id, so that INVALID_PAGE_ID comes back as itself. */
+  static page_id_t KeyOf(uint64_t entry) { return static_cast<page_id_t>(static_cast<int64_t>(entry) >> FRAME_BITS); }
+  static frame_id_t ValueOf(uint64_t entry) { return static_cast<frame_id_t>(entry & FRAME_MASK); }
+
+  /** An array of slots, sized for a maximum number of entries at a load factor of at most one half. */
+  struct Slots {
+    explicit Slots(size_t max_entries);
+
+    /** Fibonacci hashing, which spreads the consecutive page ids of a table heap over the whole array. */
+    size_t HomeSlot(page_id_t page_id) const {
+      return static_cast<size_t>(((static_cast<uint64_t>(page_id) & PAGE_MASK) * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    /** Number of slots minus one; the number of slots is a power of two. */
+    size_t mask_;
+    /** 64 - log2(number of slots). */
+    int shift_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  };
+
+  /** Number of entries. */
+  size_t size_{0};
+  /** The array that Find probes; the last one of tables_. */
+  std::atomic<Slots *> table_;
+  /** Every array that the table ever had, oldest first. */
+  std::vector<std::unique_ptr<Slots>> tables_;
+};
+
+}  // namespace bustub
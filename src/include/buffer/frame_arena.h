@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** How FrameArena asks the kernel for huge pages. */
+enum class HugePageMode {
+  /** Regular pages only. Mostly useful as a baseline in benchmarks. */
+  NONE,
+  /** Transparent huge pages via madvise(MADV_HUGEPAGE), which the kernel applies as it sees fit. */
+  TRANSPARENT,
+  /**
+   * Huge pages from the reserved hugetlbfs pool via MAP_HUGETLB. Only the frames that are in use take huge pages, which
+   * are reserved as the buffer pool grows and given back as it shrinks. Once the hugetlbfs pool runs out, the arena
+   * falls back to TRANSPARENT.
+   */
+  EXPLICIT,
+};
+
+/** Placement options for the frame data of a buffer pool, see FrameArena. */
+struct FrameArenaOptions {
+  /** Value of numa_node that leaves the placement to the kernel. */
+  static constexpr int NO_NUMA_NODE = -1;
+
+  /** How to ask for huge pages. */
+  HugePageMode huge_pages{HugePageMode::TRANSPARENT};
+  /** The NUMA node on which the frames are preferably allocated, or NO_NUMA_NODE. */
+  int numa_node{NO_NUMA_NODE};
+  /**
+   * The number of frames that a buffer pool instance may grow to with Resize, if that is more than it starts out with.
+   * Only address space is reserved for them, no memory.
+   */
+  size_t max_pool_size{BUFFER_POOL_MAX_SIZE};
+  /**
+   * Only used by ParallelBufferPoolManager: places instance i on NUMA node (i mod the number of nodes), overriding
+   * numa_node.
+   */
+  bool numa_local_instances{false};
+};
+
+/**
+ * FrameArena holds the page data of a buffer pool in one address range, apart from the book-keeping in Page. The
+ * range is aligned to HUGE_PAGE_SIZE, so that the frames can be mapped with as few TLB entries as possible, and frame
+ * i starts at offset i * FRAME_SIZE. Every frame is thus aligned to DIRECT_IO_ALIGNMENT, as a DiskManager that uses
+ * direct I/O wants it to be, even if pages are smaller than that. Address space is reserved for the full capacity up
+ * front, but memory is only committed when a frame is first touched. Explicit huge pages cannot be committed lazily,
+ * so they are only mapped over the frames that Commit declares in use.
+ */
+class FrameArena {
+ public:
+  /** The huge page size that the arena aligns to. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+  /** The distance between two frames: a page, rounded up to DIRECT_IO_ALIGNMENT. */
+  static constexpr size_t FRAME_SIZE = std::max<size_t>(PAGE_SIZE, DIRECT_IO_ALIGNMENT);
+
+  /**
+   * Reserves address space for capacity frames.
+   * @param capacity the maximum number of frames
+   * @param options huge page and NUMA placement
+   */
+  FrameArena(size_t capacity, const FrameArenaOptions &options);
+
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data of frame frame_id */
+  char *GetFrameData(size_t frame_id) const { return data_ + frame_id * FRAME_SIZE; }
+
+  /** @return the number of frames for which address space is reserved */
+  size_t GetCapacity() const { return capacity_; }
+
+  /** @return true if the frames in use are backed by explicitly reserved huge pages */
+  bool UsesExplicitHugePages() const { return explicit_huge_pages_; }
+
+  /**
+   * Declares frames [0, end) in use, before they are first touched. With explicit huge pages, this reserves the huge
+   * pages that they take; otherwise there is nothing to do.
+   * @param end one past the last frame in use
+   */
+  void Commit(size_t end);
+
+  /**
+   * Gives the memory of frames [begin, capacity) back to the operating system. The frames read as zeroes afterwards.
+   * @param begin the first frame to release
+   */
+  void Release(size_t begin);
+
+  /** @return the number of NUMA nodes of this machine, 1 if it cannot be determined */
+  static int GetNumaNodeCount();
+
+ private:
+  /** Number of frames. */
+  const size_t capacity_;
+  /** Size of the mapping at base_, a multiple of HUGE_PAGE_SIZE. */
+  size_t mapping_size_;
+  /** Start of the mapping. */
+  char *base_;
+  /** The first HUGE_PAGE_SIZE aligned address in the mapping, where frame 0 starts. */
+  char *data_;
+  /** Replaces [offset, data_size_) of the data with regular pages, as used for TRANSPARENT. */
+  void MapRegular(size_t offset);
+
+  /** Applies the NUMA placement to [offset, offset + size) of the data. */
+  void BindToNode(size_t offset, size_t size);
+
+  /** Size of the frames, rounded up to HUGE_PAGE_SIZE. */
+  size_t data_size_;
+  /** True while Commit maps explicit huge pages. */
+  bool explicit_huge_pages_{false};
+  /** The first huge_size_ bytes of the data are mapped with MAP_HUGETLB, a multiple of HUGE_PAGE_SIZE. */
+  size_t huge_size_{0};
+  /** See FrameArenaOptions::numa_node. */
+  int numa_node_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil, O'Neil and Weikum, 1993).
+ *
+ * The victim is the frame with the largest backward k-distance, i.e. whose k-th most recent reference lies furthest
+ * in the past. Frames with fewer than k references have an infinite backward k-distance and are evicted first, oldest
+ * reference first. A page that is touched once by a scan thus goes before a page that is looked up again and again.
+ *
+ * Time is logical: every Unpin is a reference and advances the clock by one. A reference that follows the previous
+ * reference of the same frame within the correlated reference period (e.g. the repeated pins of an inner page during a
+ * single B+ tree descent) is treated as part of that reference and does not add to the frame's history.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references to look back on
+   * @param correlated_period references within this many ticks of the previous one are correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_period = LRUK_CORRELATED_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void GetVictimOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  void Resize(size_t num_pages) override;
+
+ private:
+  /** Records a reference to frame_id at the current time. */
+  void RecordReference(size_t frame_id);
+
+  /** @return true if frame a should be evicted before frame b */
+  bool EvictsBefore(size_t a, size_t b) const;
+
+  /** Adds a frame to the heap of evictable frames. */
+  void HeapPush(size_t frame_id);
+
+  /** Removes a frame from the heap of evictable frames. */
+  void HeapRemove(size_t frame_id);
+
+  /** Swaps heap slots i and j and updates heap_index_ accordingly. */
+  void HeapSwap(size_t i, size_t j);
+
+  /** Restores the heap property for the frame at heap slot i, which may have to move up or down. */
+  void HeapFix(size_t i);
+
+  /** The value of heap_index_ for frames that are not in the replacer. */
+  static constexpr size_t NOT_IN_HEAP = static_cast<size_t>(-1);
+
+  size_t num_pages_;
+  size_t k_;
+  uint64_t correlated_period_;
+  /** The logical clock. */
+  uint64_t current_timestamp_{0};
+  /** history_[frame * k_ + i] is the time of the (i + 1)-th most recent uncorrelated reference to frame. */
+  std::vector<uint64_t> history_;
+  /** Number of valid entries in the history of every frame, at most k_. */
+  std::vector<size_t> history_size_;
+  /** Time of the most recent reference, correlated or not, to every frame. */
+  std::vector<uint64_t> last_reference_;
+  /**
+   * The frames in the replacer, as a binary heap whose top is the next victim. A frame's history only changes while
+   * it is pinned, so its position in the heap stays valid for as long as it is in the replacer.
+   */
+  std::vector<size_t> heap_;
+  /** heap_index_[i] is the slot of frame i in heap_, or NOT_IN_HEAP if frame i is not in the replacer. */
+  std::vector<size_t> heap_index_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
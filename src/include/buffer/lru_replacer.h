@@ -47,6 +47,10 @@ class LRUReplacer : public Replacer {
 
   size_t Size() override;
 
+  void GetVictimOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  void Resize(size_t num_pages) override;
+
  private:
   size_t num_pages_;
   std::list<frame_id_t> list_;
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several BufferPoolManagerInstances, each with its own frames,
+ * page table, replacer and latch. A page always lives in instance (page_id mod num_instances), so operations on
+ * different pages mostly contend on different latches.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param policy the replacement policy of every BufferPoolManagerInstance
+   * @param arena_options huge page and NUMA placement of the frames of every BufferPoolManagerInstance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacementPolicy policy = ReplacementPolicy::LRU,
+                            const FrameArenaOptions &arena_options = {});
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  size_t GetPoolSize() override;
+
+  /**
+   * Spreads pool_size frames evenly over the instances and resizes each of them. If an instance fails to shrink, the
+   * others keep their new size.
+   * @param pool_size the new total size of the buffer pool, at least the number of instances
+   * @return true if every instance was resized
+   */
+  bool Resize(size_t pool_size) override;
+
+  /**
+   * Splits the pages by instance and forwards them to the responsible BufferPoolManagerInstances.
+   * @param page_ids ids of the pages to read ahead
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Splits the batch by instance and lets every instance fetch its share with a single latch acquisition.
+   * @param[in,out] page_ids ids of the pages to fetch; sorted and deduplicated on return
+   * @return the pages in the order of page_ids, nullptr where a page could not be fetched
+   */
+  std::vector<Page *> FetchPages(std::vector<page_id_t> *page_ids) override;
+
+  Page *FetchPageIfResident(page_id_t page_id) override;
+
+  /** Forwards to the instance of the child; the parent may belong to any instance. */
+  Page *FetchChildPage(Page *parent, size_t slot, page_id_t child_page_id) override;
+
+  /** Starts a background writer in every instance, each with the given options. */
+  void StartBackgroundWriter(const BackgroundWriterOptions &options) override;
+
+  void StopBackgroundWriter() override;
+
+  /** Saves a single snapshot: the resident pages of every instance, one instance after the other. */
+  bool SaveSnapshot() override;
+
+  /** Hands the snapshot to every instance, each of which warms up with its own pages. */
+  bool LoadSnapshot() override;
+
+  /** Shares the AsyncDiskManager among all instances. */
+  void SetAsyncDiskManager(AsyncDiskManager *async_disk_manager) override;
+
+  /** @return the number of instances that the pages are sharded across */
+  size_t GetNumInstances() const { return instances_.size(); }
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return the BufferPoolManagerInstance responsible for handling the given page id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
+
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried round-robin, starting one past the instance that the
+   * previous call started at, so that new pages spread evenly over the shards.
+   * @param[out] page_id id of created page
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Creates a new page close to a related page. The search starts at the instance that owns the page right after the
+   * related one, which is where the new page continues it on disk.
+   * @param[out] page_id id of created page
+   * @param near_page_id the related page, or INVALID_PAGE_ID for the behavior of NewPageImpl
+   * @return nullptr if no instance could create a new page, otherwise pointer to new page
+   */
+  Page *NewPageNearImpl(page_id_t *page_id, page_id_t near_page_id) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The shards, indexed by page_id mod instances_.size(). */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The disk manager that all instances share, which keeps the snapshot file. */
+  DiskManager *disk_manager_;
+  /** The instance that the next NewPage starts searching at. */
+  std::atomic<size_t> next_instance_{0};
+};
+}  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
@@ -38,13 +40,28 @@ class Replacer {
   virtual void Pin(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
+   * Unpins a frame, indicating that it can now be victimized. Frames beyond the number of frames are ignored: the
+   * buffer pool unpins without its latch, and may do so right after Resize has removed the frame.
    * @param frame_id the id of the frame to unpin
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Lists the frames in the replacer in the order in which they would be victimized if nothing else happened, without
+   * changing any state. Policies that only approximate an order list the frames in their best guess of it.
+   * @param[out] frame_ids the frames in the replacer, the next victim first
+   */
+  virtual void GetVictimOrder(std::vector<frame_id_t> *frame_ids) = 0;
+
+  /**
+   * Changes the number of frames that the replacer tracks. When shrinking, frames with ids >= num_pages are forgotten
+   * whether or not they are in the replacer; the buffer pool never hands them out again.
+   * @param num_pages the new number of frames
+   */
+  virtual void Resize(size_t num_pages) = 0;
 };
 
 }  // namespace bustub
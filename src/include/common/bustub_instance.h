@@ -12,7 +12,7 @@
 
 #include <string>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -23,16 +23,33 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * Creates the database components on top of a database file. If a buffer pool snapshot was saved next to the file
+   * on the last shutdown, the buffer pool starts warming up from it in the background. Pages are written with
+   * checksums, which are verified when they are read.
+   * @param db_file_name the database file
+   * @param buffer_pool_size the initial number of frames of the buffer pool, which can later be changed with
+   * BufferPoolManager::Resize
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t buffer_pool_size = BUFFER_POOL_SIZE)
+      : BustubInstance(new DiskManager(db_file_name, ChecksummedPages()), buffer_pool_size) {}
+
+  /**
+   * Creates the database components on top of any disk manager, e.g. a MemoryDiskManager for benchmarks.
+   * @param disk_manager the disk manager, which the instance takes ownership of
+   * @param buffer_pool_size the initial number of frames of the buffer pool
+   */
+  explicit BustubInstance(DiskManager *disk_manager, size_t buffer_pool_size = BUFFER_POOL_SIZE) {
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = disk_manager;
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManagerInstance(buffer_pool_size, disk_manager_, log_manager_);
+    buffer_pool_manager_->LoadSnapshot();
 
     // txn related
     lock_manager_ = new LockManager();
@@ -42,10 +59,12 @@ class BustubInstance {
     checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
   }
 
+  /** Shuts the components down, and saves a snapshot of the buffer pool for the next start. */
   ~BustubInstance() {
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
+    buffer_pool_manager_->SaveSnapshot();
     delete checkpoint_manager_;
     delete log_manager_;
     delete buffer_pool_manager_;
@@ -55,11 +74,19 @@ class BustubInstance {
   }
 
   DiskManager *disk_manager_;
-  BufferPoolManager *buffer_pool_manager_;
+  BufferPoolManagerInstance *buffer_pool_manager_;
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+
+ private:
+  /** @return the options of a database that is opened by file name */
+  static DiskManagerOptions ChecksummedPages() {
+    DiskManagerOptions options;
+    options.page_checksums = true;
+    return options;
+  }
 };
 
 }  // namespace bustub
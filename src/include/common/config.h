@@ -31,13 +31,36 @@ static constexpr int INVALID_PAGE_ID = -1;                                    //
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
+#ifdef BUSTUB_PAGE_SIZE
+static constexpr int PAGE_SIZE = BUSTUB_PAGE_SIZE;                            // size of a data page in byte
+#else
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+#endif
+static constexpr int PAGE_CHECKSUM_SIZE = 4;                                  // trailer of a page for its checksum
+static constexpr int PAGE_USABLE_SIZE = PAGE_SIZE - PAGE_CHECKSUM_SIZE;       // bytes that page layouts may use
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
+static constexpr int BUFFER_POOL_MAX_SIZE = 1 << 16;                          // max frames of a buffer pool instance
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int LRUK_CORRELATED_PERIOD = 4;                              // lru-k correlated reference period
+static constexpr int SCAN_READAHEAD_PAGES = 4;                                // pages a table iterator reads ahead
+static constexpr int TUPLE_FETCH_BATCH_SIZE = 64;                             // rids that index executors fetch at once
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // async disk requests in flight
+static constexpr int64_t DB_SEGMENT_SIZE = int64_t{1} << 30;                  // size of a database segment file in byte
+static constexpr int DB_EXTENT_SIZE = 8;                                      // pages in an extent of related pages
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;                              // buffer alignment that O_DIRECT needs
+
+// Every page layout derives its capacity from PAGE_SIZE, which the BUSTUB_PAGE_SIZE build option selects.
+static_assert(PAGE_SIZE >= 1024 && (PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "PAGE_SIZE must be a power of two >= 1024.");
+static_assert(DB_SEGMENT_SIZE % PAGE_SIZE == 0, "A segment must hold whole pages.");
 
 using frame_id_t = int32_t;    // frame id type
+#ifdef BUSTUB_PAGE_ID_64
+using page_id_t = int64_t;     // page id type, see the BUSTUB_PAGE_ID_64 build option
+#else
 using page_id_t = int32_t;     // page id type
+#endif
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
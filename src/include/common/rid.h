@@ -32,9 +32,14 @@ class RID {
    */
   RID(page_id_t page_id, uint32_t slot_num) : page_id_(page_id), slot_num_(slot_num) {}
 
-  explicit RID(int64_t rid) : page_id_(static_cast<page_id_t>(rid >> 32)), slot_num_(static_cast<uint32_t>(rid)) {}
+  /**
+   * Unpacks a RID from Get(). The slot number takes the low 32 bits, or the low 16 bits with 64-bit page ids, which
+   * leaves page ids of up to 47 bits.
+   */
+  explicit RID(int64_t rid)
+      : page_id_(static_cast<page_id_t>(rid >> SLOT_BITS)), slot_num_(static_cast<uint32_t>(rid & SLOT_MASK)) {}
 
-  inline int64_t Get() const { return (static_cast<int64_t>(page_id_)) << 32 | slot_num_; }
+  inline int64_t Get() const { return (static_cast<int64_t>(page_id_)) << SLOT_BITS | slot_num_; }
 
   inline page_id_t GetPageId() const { return page_id_; }
 
@@ -61,6 +66,9 @@ class RID {
   bool operator==(const RID &other) const { return page_id_ == other.page_id_ && slot_num_ == other.slot_num_; }
 
  private:
+  static constexpr int SLOT_BITS = sizeof(page_id_t) == 4 ? 32 : 16;
+  static constexpr int64_t SLOT_MASK = (int64_t{1} << SLOT_BITS) - 1;
+
   page_id_t page_id_{INVALID_PAGE_ID};
   uint32_t slot_num_{0};  // logical offset from 0, 1...
 };
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli), the checksum that iSCSI, ext4 and most storage engines use. Where the build
+ * targets SSE4.2 or ARMv8 with the CRC extension, the processor's CRC32C instructions compute it; elsewhere a
+ * table-driven implementation that processes eight bytes at a time does.
+ */
+class Crc32c {
+ public:
+  /** @return the CRC-32C of length bytes at data */
+  static uint32_t Value(const char *data, size_t length) { return Extend(0, data, length); }
+
+  /**
+   * @param crc the CRC-32C of some preceding bytes
+   * @return the CRC-32C of those bytes followed by length bytes at data
+   */
+  static uint32_t Extend(uint32_t crc, const char *data, size_t length);
+
+  /** Like Extend, but always with the table-driven implementation. */
+  static uint32_t ExtendPortable(uint32_t crc, const char *data, size_t length);
+
+  /** @return true if Extend uses the processor's CRC32C instructions */
+  static bool IsHardwareAccelerated();
+};
+
+}  // namespace bustub
@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4.h
+//
+// Identification: src/include/common/util/lz4.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * Lz4 compresses into and decompresses from the LZ4 block format: a sequence of literal runs, each followed by a
+ * back-reference of at least four bytes into the last 64 KB of output. The compressor is the greedy single-pass one of
+ * the reference implementation, which trades ratio for speed, so that a page compresses in a few microseconds. Blocks
+ * carry no sizes of their own; the caller keeps track of both.
+ */
+class Lz4 {
+ public:
+  /**
+   * @param src the data to compress
+   * @param src_size the number of bytes at src, at most 2 GB
+   * @param[out] dst the compressed block
+   * @param dst_capacity the number of bytes available at dst
+   * @return the size of the compressed block, or 0 if it does not fit into dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * @param src a compressed block
+   * @param src_size the size of the block
+   * @param[out] dst the decompressed data
+   * @param dst_size the exact number of bytes that the block decompresses to
+   * @return false if the block is damaged or does not decompress to exactly dst_size bytes; dst is undefined then
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+};
+
+}  // namespace bustub
@@ -44,11 +44,23 @@ class IndexScanExecutor : public AbstractExecutor {
   Tuple GenerateOutputTuple(const Tuple &tuple);
 
  private:
+  /**
+   * Reads the next TUPLE_FETCH_BATCH_SIZE rids from the index and fetches their tuples with one TableHeap::GetTuples.
+   * @return false if the index is exhausted
+   */
+  bool FetchBatch();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   IndexInfo *index_info_;
   TableMetadata *table_meta_data_;
   BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *index_;
   IndexIterator<GenericKey<8>, RID, GenericComparator<8>> cur_index_iter_;
+  /** The rids of the current batch, in index order. */
+  std::vector<RID> batch_rids_;
+  /** The tuples of the current batch, batch_tuples_[i] being the tuple at batch_rids_[i]. */
+  std::vector<Tuple> batch_tuples_;
+  /** The position of the next tuple to emit in the current batch. */
+  size_t batch_cursor_{0};
 };
 }  // namespace bustub
@@ -52,11 +52,26 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   Tuple GenerateKeyTuple(const Tuple &tuple, const Schema *key_schema);
 
  private:
+  /**
+   * Probes the index with up to TUPLE_FETCH_BATCH_SIZE outer tuples that have a match, and fetches the matching inner
+   * tuples with one TableHeap::GetTuples.
+   * @return false if the outer side is exhausted
+   */
+  bool FetchBatch();
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
 
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableMetadata *inner_table_meta_data_;
   IndexInfo *index_;
+  /** The outer tuples of the current batch. */
+  std::vector<Tuple> left_tuples_;
+  /** The rids of the inner tuples that match left_tuples_, one per outer tuple. */
+  std::vector<RID> right_rids_;
+  /** The inner tuples at right_rids_. */
+  std::vector<Tuple> right_tuples_;
+  /** The position of the next pair to join in the current batch. */
+  size_t batch_cursor_{0};
 };
 }  // namespace bustub
@@ -13,9 +13,12 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>  // NOLINT
+#include <cstdint>
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,16 +28,30 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log is double-buffered: records are appended to log_buffer_ while the flush thread writes flush_buffer_, and the
+ * thread swaps the two before every write. Besides the timeout and a full buffer, a transaction that commits wakes the
+ * thread with Flush and waits until its commit record is on disk. Every write takes all the records that are buffered
+ * by then, so transactions that commit while a write is in progress share the next write, and its sync.
+ *
+ * Appending does not take latch_. An appender reserves the room for its record and its LSN together, with one
+ * fetch-add on reservation_, and serializes the record into its range while others do the same; copied_ counts the
+ * bytes whose copy is complete. A reservation that does not fit seals the buffer: it and all reservations after it
+ * fail, wait for the swap and retry. Since they come after every successful one, the swap rewinds the LSN to the
+ * first failed reservation, and the LSNs stay dense. The flush thread seals the buffer itself when it has to write
+ * a buffer that is not full, and before the write it waits until copied_ has caught up with the sealed size.
  */
 class LogManager {
  public:
   explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+      : reservation_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
+  /** Stops the flush thread if it is still running, which writes what is left in the buffer. */
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,29 +63,80 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Blocks until the log records up to and including lsn are on disk. If they are still buffered, the flush thread is
+   * woken, or, if there is none, the buffer is written by the caller.
+   * @param lsn the last record that has to be persistent, e.g. a commit record; at most the last appended one
+   */
+  void Flush(lsn_t lsn);
+
+  /** @return the LSN of the next record; while a full buffer waits for its swap, it counts the failed reservations */
+  inline lsn_t GetNextLSN() { return LsnOf(reservation_); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline char *GetLogBuffer() { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
-
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** The body of flush_thread_: writes the buffer on every wakeup until it is stopped and the buffer is empty. */
+  void FlushLoop();
+
+  /** Blocks a failed reservation until the sealed buffer has been swapped, writing it if there is no flush thread. */
+  void WaitForSwap();
+
+  /**
+   * Seals log_buffer_, waits until its records are copied, swaps the buffers and writes the records, with latch_
+   * released during the write.
+   * @param lock the held lock on latch_
+   */
+  void FlushBuffer(std::unique_lock<std::mutex> *lock);
+
+  /** reservation_ holds the next LSN in its upper and the reserved bytes of log_buffer_ in its lower 32 bits. */
+  static constexpr uint64_t LSN_ONE = uint64_t{1} << 32;
+  static constexpr uint64_t NO_SEAL = UINT64_MAX;
+  static lsn_t LsnOf(uint64_t reservation) { return static_cast<lsn_t>(reservation >> 32); }
+  static uint64_t OffsetOf(uint64_t reservation) { return reservation & (LSN_ONE - 1); }
+
+  /**
+   * Writes a log record in the format that is described in log_record.h.
+   * @param log_record the record, whose size and LSN are set
+   * @param[out] data where to write the record, at least log_record->GetSize() bytes
+   */
+  static void SerializeLogRecord(LogRecord *log_record, char *data);
+
+  /**
+   * The next LSN and the number of bytes of log_buffer_ that are reserved, see LSN_ONE. The buffer is sealed once the
+   * reserved bytes exceed LOG_BUFFER_SIZE.
+   */
+  std::atomic<uint64_t> reservation_;
+  /** Number of bytes of log_buffer_ whose records are completely copied. */
+  std::atomic<uint64_t> copied_{0};
+  /** The reservation_ before the failed reservation that sealed log_buffer_, until the flush thread takes it. */
+  std::atomic<uint64_t> seal_{NO_SEAL};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** The buffer that records are appended to; only swapped once all of its reservations are copied. */
   char *log_buffer_;
+  /** The buffer that is being written, while flushing_ is set. */
   char *flush_buffer_;
-
+  /** True while flush_buffer_ is being written. */
+  bool flushing_{false};
+  /** Set to wake the flush thread before its timeout, by a full buffer or a commit. */
+  bool flush_requested_{false};
+  /** Set by StopFlushThread to make the flush thread exit once the buffer is empty. */
+  bool stop_{false};
+
+  /** Protects the flags above, and serializes the sealing and swapping of the buffers. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Signalled on a swap, for failed reservations, and when a write completes, for committers that wait. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
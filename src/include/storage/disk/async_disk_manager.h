@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager reads and writes the pages of a DiskManager's database file without blocking the caller, so that
+ * one thread can keep many requests in flight. A request completes by invoking its callback, or by fulfilling the
+ * future that the callback-less overloads return.
+ *
+ * On Linux the requests go through an io_uring, and a completion thread reaps them and runs the callbacks. Where
+ * io_uring is not available, or not permitted, a pool of threads serves the requests with the synchronous DiskManager
+ * calls instead. Either way a request has the same semantics as DiskManager::ReadPage and WritePage: reads beyond the
+ * end of the file return zeroes, and a completed write is visible to later reads but is not durable until
+ * DiskManager::SyncDataFile.
+ *
+ * Callbacks run on an internal thread. They must not block on further requests of the same AsyncDiskManager, and must
+ * not take locks that a thread holds while it submits requests, since a submission waits for a free slot when the
+ * queue is full.
+ */
+class AsyncDiskManager {
+ public:
+  /** Invoked once a request is complete; the argument is false if the I/O failed. */
+  using Callback = std::function<void(bool)>;
+
+  /** The mechanism that performs the requests. */
+  enum class Backend {
+    /** A Linux io_uring, driven by a completion thread. */
+    IO_URING,
+    /** Worker threads that call the blocking DiskManager functions. */
+    THREAD_POOL,
+  };
+
+  /**
+   * Creates an AsyncDiskManager on top of a DiskManager, which must outlive it.
+   * @param disk_manager the disk manager whose database file is read and written
+   * @param queue_depth the maximum number of requests in flight; further submissions wait
+   * @param backend the preferred backend; IO_URING falls back to THREAD_POOL if the kernel refuses it, or if the disk
+   * manager is not file-backed
+   */
+  explicit AsyncDiskManager(DiskManager *disk_manager, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                            Backend backend = Backend::IO_URING);
+
+  /** Waits for the requests in flight, then stops the internal threads. */
+  ~AsyncDiskManager();
+
+  DISALLOW_COPY_AND_MOVE(AsyncDiskManager);
+
+  /**
+   * Starts reading a page.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer of PAGE_SIZE bytes, which must stay valid until the callback runs
+   * @param callback invoked once the page is in page_data
+   */
+  void ReadPageAsync(page_id_t page_id, char *page_data, Callback callback);
+
+  /**
+   * Starts writing a page.
+   * @param page_id id of the page
+   * @param page_data the page content, which must stay valid and unmodified until the callback runs
+   * @param callback invoked once the page is written
+   */
+  void WritePageAsync(page_id_t page_id, const char *page_data, Callback callback);
+
+  /** Like ReadPageAsync with a callback, but returns a future instead. */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /** Like WritePageAsync with a callback, but returns a future instead. */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /** Blocks until every request that has been submitted so far has completed and its callback has returned. */
+  void WaitForAll();
+
+  /** @return the backend in use */
+  Backend GetBackend() const { return backend_; }
+
+ private:
+  struct Request {
+    page_id_t page_id_;
+    char *data_;
+    bool is_write_;
+    Callback callback_;
+    /** The buffer as the kernel sees it while the request is in the ring. */
+    iovec iov_;
+    /** A copy of the page with its checksum, which the ring writes instead of data_; see DiskManager::WritePage. */
+    char *stamped_{nullptr};
+  };
+
+  /** Waits for a free slot, then hands the request to the backend. */
+  void Submit(Request *request);
+
+  /** Runs the callback of a request, frees it and releases its slot. */
+  void Complete(Request *request, bool success);
+
+  /** Sets up the io_uring. @return false if the kernel does not support or permit it */
+  bool SetUpRing();
+
+  /** Places a request in the submission queue and enters the kernel. Requires submit_latch_. */
+  void SubmitToRing(Request *request);
+
+  /** The body of completion_thread_: reaps completions until the ring is shut down. */
+  void CompletionLoop();
+
+  /** The body of the worker threads of the THREAD_POOL backend. */
+  void WorkerLoop();
+
+  DiskManager *disk_manager_;
+  const size_t queue_depth_;
+  Backend backend_;
+
+  /** Number of submitted requests whose callback has not returned yet. */
+  size_t in_flight_{0};
+  /** Signalled whenever a request completes. */
+  std::condition_variable in_flight_cv_;
+  /** Protects in_flight_. */
+  std::mutex in_flight_latch_;
+
+  /** The io_uring file descriptor, or -1. */
+  int ring_fd_{-1};
+  /** The mappings of the submission ring, the completion ring (may be the same) and the submission queue entries. */
+  void *sq_ring_{nullptr};
+  void *cq_ring_{nullptr};
+  void *sqes_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  size_t sqes_size_{0};
+  /** Pointers into the rings, see struct io_sqring_offsets and io_cqring_offsets. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Serializes submitters of the ring. */
+  std::mutex submit_latch_;
+  std::thread completion_thread_;
+
+  /** Requests waiting for a worker of the THREAD_POOL backend. */
+  std::deque<Request *> queue_;
+  std::vector<std::thread> workers_;
+  bool shutdown_{false};
+  std::condition_variable queue_cv_;
+  /** Protects queue_ and shutdown_. */
+  std::mutex queue_latch_;
+};
+
+}  // namespace bustub
@@ -13,53 +13,138 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/free_space_map.h"
+#include "storage/disk/page_extent_map.h"
 
 namespace bustub {
 
+/** Layout options for the files of a database, see DiskManager. */
+struct DiskManagerOptions {
+  /** Size of a segment file in bytes; a multiple of PAGE_SIZE. */
+  int64_t segment_size{DB_SEGMENT_SIZE};
+  /**
+   * Directories, typically on different devices, over which segments 1, 2, ... are spread round robin. If empty, all
+   * segments are placed next to the database file. Segment 0 is always the database file itself.
+   */
+  std::vector<std::string> segment_dirs;
+  /**
+   * Open the segment files with O_DIRECT, so that pages bypass the operating system's page cache and are only cached
+   * in the buffer pool. Where the file system refuses direct I/O, the files are opened for buffered I/O instead.
+   */
+  bool direct_io{false};
+  /**
+   * Store a CRC32C checksum of every page in its trailer when the page is written, see PAGE_CHECKSUM_SIZE. Must be the
+   * same every time the database is opened. Off by default, so that pages round-trip byte for byte; BustubInstance
+   * turns it on.
+   */
+  bool page_checksums{false};
+  /** Verify the checksum of every page that is read; see DiskManager::SetVerifyChecksums. */
+  bool verify_checksums{true};
+  /**
+   * Store pages compressed, each in as many sectors of the database file as it needs, see PageExtentMap. The database
+   * is then a single file that is not opened for direct I/O, so segment_size, segment_dirs and direct_io do not apply.
+   * Must be the same every time the database is opened.
+   */
+  bool compression{false};
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The database is a sequence of segment files of segment_size bytes each: page p lives at byte offset
+ * p * PAGE_SIZE of the database, which is in segment p * PAGE_SIZE / segment_size. Segment 0 is the database file,
+ * segment k > 0 is named after it with the suffix ".k". Segments are created in order as the database grows, so a
+ * database that fits into one segment is a single file as before. All offsets are 64-bit.
+ *
+ * Pages are read and written with pread/pwrite, so any number of threads may read and write pages at the same time. A
+ * written page is visible to every later read right away, but only durable once SyncDataFile returns.
+ *
+ * With direct I/O, page buffers and offsets have to be aligned to DIRECT_IO_ALIGNMENT. The frames of a buffer pool
+ * are, see FrameArena; other buffers are copied through an aligned buffer of the calling thread. A file whose file
+ * system rejects direct I/O, either when it is opened or on the first transfer, silently falls back to buffered I/O.
+ *
+ * With page checksums, WritePage stores the CRC32C of the first PAGE_USABLE_SIZE bytes of a page in its trailer, on
+ * disk only: the caller's buffer is not modified. ReadPage verifies the checksum if asked to, and counts and logs the
+ * pages that fail, whose content is returned as it is. A page of zeroes, which has never been written, is valid.
+ *
+ * With compression, WritePage compresses every page with LZ4 and stores its length and compressed form in a run of
+ * sectors of the database file. A page that does not compress below a page less a sector is stored as it is, and a
+ * page of zeroes is not stored at all. Where each page is stored is kept in a PageExtentMap, in a file with the suffix
+ * ".pmap" next to the database file, which SyncDataFile persists after the pages. The size of the database is then
+ * the number of pages times PAGE_SIZE, not the size of the file.
+ *
+ * Which pages are allocated is kept in a FreeSpaceMap, in a file with the suffix ".fsm" next to the database file,
+ * which SyncDataFile persists along with the pages.
+ *
+ * The page and log I/O functions are virtual, so that MemoryDiskManager and SimulatedLatencyDiskManager can stand in
+ * for the files, e.g. to benchmark the buffer pool without a device.
  */
 class DiskManager {
  public:
   /**
-   * Creates a new disk manager that writes to the specified database file.
+   * Creates a new disk manager that writes to the specified database file, and opens the segments that follow it.
    * @param db_file the file name of the database file to write to
+   * @param options the segment layout; must be the same every time the database is opened
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, const DiskManagerOptions &options = DiskManagerOptions());
+
+  /** Closes the database file if ShutDown has not done so. */
+  virtual ~DiskManager();
 
-  ~DiskManager() = default;
+  DISALLOW_COPY_AND_MOVE(DiskManager);
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager and close all the file resources. Pages that have been written are synced first.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Write a batch of pages, like WritePage each, but with one pwritev for every run of consecutive pages in a segment.
+   * The pages are not synced either; a flush of many pages is best followed by a single SyncDataFile.
+   * @param page_ids ids of the pages, sorted so that consecutive pages are neighbours
+   * @param pages raw page data, in the order of page_ids
+   * @return for every page, whether it was written; a run that fails to write fails all its pages
+   */
+  virtual std::vector<bool> WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &pages);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. The part of the page that lies beyond the end of the file reads as zeroes, and
+   * so does a page that cannot be read.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Makes all pages written so far durable, with one fdatasync of every segment file, and persists the allocation of
+   * pages.
+   */
+  virtual void SyncDataFile();
+
+  /**
+   * Flush the entire log buffer into disk, and sync the log file.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,28 +153,106 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  virtual bool ReadLog(char *log_data, int size, int64_t offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk, reusing a deallocated page if there is one. See FreeSpaceMap::Allocate.
+   * @param near_page_id a page that the new one should follow on disk, e.g. the previous page of a chain, or
+   * INVALID_PAGE_ID
+   * @param stride only page ids that are residue modulo stride are allocated
+   * @param residue see stride
    * @return the id of the allocated page
    */
-  page_id_t AllocatePage();
+  virtual page_id_t AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID, uint32_t stride = 1, uint32_t residue = 0);
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that a later AllocatePage may reuse it.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(page_id_t page_id);
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  virtual bool IsPageAllocated(page_id_t page_id) { return free_space_map_->IsAllocated(page_id); }
+
+  /**
+   * Writes a buffer pool snapshot to the file next to the database file, replacing the previous one. The snapshot is
+   * written under a temporary name and then renamed, so that a crash leaves either the old or the new one behind.
+   * @param page_ids ids of the resident pages, see BufferPoolManager::SaveSnapshot
+   * @return false if the snapshot could not be written
+   */
+  virtual bool WriteSnapshot(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Reads the buffer pool snapshot that was last written next to the database file. Pages that lie beyond the end of
+   * the database file are dropped, since their content never made it to disk.
+   * @param[out] page_ids ids of the pages, in the order in which they were written
+   * @return false if there is no snapshot or it is damaged
+   */
+  virtual bool ReadSnapshot(std::vector<page_id_t> *page_ids);
+
+  /** @return the name of the buffer pool snapshot file */
+  const std::string &GetSnapshotFileName() const { return snapshot_name_; }
 
   /** @return the number of disk flushes */
-  int GetNumFlushes() const;
+  virtual int GetNumFlushes() const;
 
   /** @return true iff the in-memory content has not been flushed yet */
-  bool GetFlushState() const;
+  virtual bool GetFlushState() const;
 
   /** @return the number of disk writes */
-  int GetNumWrites() const;
+  virtual int GetNumWrites() const;
+
+  /** @return the number of SyncDataFile calls */
+  virtual int GetNumSyncs() const;
+
+  /** @return the number of pages read so far whose checksum did not match */
+  virtual int GetNumChecksumFailures() const;
+
+  /** @return true if pages are written with checksums, see DiskManagerOptions::page_checksums */
+  bool UsesPageChecksums() const { return page_checksums_; }
+
+  /** @return true if ReadPage verifies page checksums */
+  bool VerifiesChecksums() const { return verify_checksums_; }
+
+  /**
+   * Switches the verification of page checksums on or off while the database is open, e.g. off for a bulk load from a
+   * trusted source. Verification is always off for a database without page checksums.
+   * @param verify true to verify the checksum of every page that is read
+   */
+  void SetVerifyChecksums(bool verify) { verify_checksums_ = verify && page_checksums_; }
+
+  /**
+   * Stores the checksum of a page in its trailer.
+   * @param page_data a page of PAGE_SIZE bytes
+   */
+  static void SetPageChecksum(char *page_data);
+
+  /**
+   * @param page_data a page of PAGE_SIZE bytes
+   * @return true if the trailer of the page holds its checksum, or if the page consists of zeroes only
+   */
+  static bool IsPageChecksumValid(const char *page_data);
+
+  /**
+   * @return true if page p lives at byte offset p * PAGE_SIZE of the segment files, which AsyncDiskManager may then
+   * access directly
+   */
+  bool IsFileBacked() const { return file_backed_; }
+
+  /** @return true if the database file was opened for direct I/O, see DiskManagerOptions::direct_io */
+  bool UsesDirectIO() const { return direct_io_; }
+
+  /** @return true if pages are stored compressed, see DiskManagerOptions::compression */
+  bool UsesCompression() const { return extent_map_ != nullptr; }
+
+  /** @return the number of segment files of the database */
+  int64_t GetNumSegments() const { return num_segments_; }
+
+  /**
+   * @param segment index of a segment
+   * @return the name of the segment file
+   */
+  std::string GetSegmentFileName(int64_t segment) const;
 
   /**
    * Sets the future which is used to check for non-blocking flushes.
@@ -100,19 +263,70 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without any files, for subclasses that keep the pages and the log elsewhere. Allocation
+   * works as usual, with a free space map that lives in memory only.
+   */
+  DiskManager();
+
+  // statistics, which subclasses keep up to date like the file-backed functions do
+  int num_flushes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
+  bool flush_log_{false};
+
  private:
-  int GetFileSize(const std::string &file_name);
+  // submits page I/O on the segment files itself, and accounts for it like WritePage
+  friend class AsyncDiskManager;
+
+  // upper bound on the number of segments, which keeps segment_fds_ from ever moving
+  static constexpr int64_t MAX_SEGMENTS = 1 << 16;
+  // upper bound on the pages that WritePages writes with one system call, well below IOV_MAX
+  static constexpr size_t MAX_WRITE_RUN = 64;
+
+  int64_t GetFileSize(const std::string &file_name);
+  void ExtendFileSize(int64_t end);
+  // opens a segment file, for direct I/O if the database uses it and the file system supports it
+  int OpenSegment(const std::string &file_name, int flags);
+  // counts and logs a page that was read with a wrong checksum
+  void VerifyPage(page_id_t page_id, const char *page_data);
+  // finds the segment file and the offset in it of a page, opening or creating segments up to it; fd is -1 on failure
+  void LocatePage(page_id_t page_id, int *fd, int64_t *offset);
+  // WritePage and ReadPage, which AsyncDiskManager also uses to redo a request; a read that fails leaves zeroes
+  bool WriteFilePage(page_id_t page_id, const char *page_data);
+  bool ReadFilePage(page_id_t page_id, char *page_data);
+  // write and read a page of a compressed database, see PageExtentMap; the write returns false on an I/O error
+  bool WriteCompressedPage(page_id_t page_id, const char *page_data);
+  void ReadCompressedPage(page_id_t page_id, char *page_data);
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the log file for fdatasync, or -1
+  int log_fd_{-1};
+  // sidecar file of the buffer pool snapshot
+  std::string snapshot_name_;
+  int64_t segment_size_;
+  std::vector<std::string> segment_dirs_;
+  // descriptors of the segment files; entries below num_segments_ are open and never change until ShutDown
+  std::unique_ptr<int[]> segment_fds_;
+  std::atomic<int64_t> num_segments_{0};
+  // serializes opening and closing segments
+  std::mutex segment_latch_;
+  // size of the db in bytes, over all segments, or the pages times PAGE_SIZE if it is compressed; only ever grows, and
+  // writing a page is the only thing that grows it
+  std::atomic<int64_t> db_file_size_{0};
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  // which pages are allocated
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  // where the pages are stored, if they are compressed
+  std::unique_ptr<PageExtentMap> extent_map_;
+  bool file_backed_{true};
+  bool direct_io_{false};
+  bool page_checksums_{false};
+  std::atomic<bool> verify_checksums_{false};
+  std::atomic<int> num_checksum_failures_{0};
+  std::future<void> *flush_log_f_{nullptr};
 };
 
 }  // namespace bustub
@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks which pages of a database are allocated, with one bit per page, and hands out page ids for
+ * DiskManager::AllocatePage. Every page below the high-water mark next_page_id_ is either allocated or free; the pages
+ * at and above it have never been allocated. Freed pages are reused before the database grows.
+ *
+ * The map lives in a file of its own next to the database file. Page 0 of that file is a header with the high-water
+ * mark, page k + 1 holds the bits of database pages [k * BITS_PER_PAGE, (k + 1) * BITS_PER_PAGE). Changes are kept in
+ * memory until Flush, which DiskManager calls whenever it syncs the database, so that after a crash the map is as of
+ * the last sync, like the pages themselves. The one exception are pages beyond the high-water mark of the map that
+ * made it into the database file anyway: they are found by the size of the file and count as allocated.
+ */
+class FreeSpaceMap {
+ public:
+  /** Number of database pages whose bits fit into one page of the map file. */
+  static constexpr int64_t BITS_PER_PAGE = int64_t{PAGE_SIZE} * 8;
+
+  /**
+   * Loads the map from its file. The file is only created by the first Flush that has something to write.
+   * @param file_name the name of the map file; if empty, the map is kept in memory only
+   * @param num_pages_in_file the number of pages in the database file; if 0, the map starts empty whatever the file
+   * holds, since a map without its database is meaningless
+   */
+  FreeSpaceMap(const std::string &file_name, int64_t num_pages_in_file);
+
+  /** Closes the map file without flushing it. */
+  ~FreeSpaceMap();
+
+  DISALLOW_COPY_AND_MOVE(FreeSpaceMap);
+
+  /**
+   * Allocates a page. Without a hint, this is the lowest free page, or the page at the high-water mark if there is
+   * none. With a hint, pages are grouped into extents of DB_EXTENT_SIZE pages: the page is taken from the rest of the
+   * hint's extent if possible, and otherwise is the first page of an extent that is entirely free, so that the pages
+   * allocated near it next are contiguous again.
+   * @param near_page_id the page that the new page is related to, e.g. its predecessor in a chain, or INVALID_PAGE_ID
+   * @param stride only page ids that are residue modulo stride are considered, see ParallelBufferPoolManager
+   * @param residue see stride
+   * @return the allocated page id
+   */
+  page_id_t Allocate(page_id_t near_page_id, uint32_t stride, uint32_t residue);
+
+  /**
+   * Frees a page for reuse. Freeing a page that is not allocated has no effect.
+   * @param page_id the page to free
+   */
+  void Deallocate(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  bool IsAllocated(page_id_t page_id);
+
+  /** @return the high-water mark: one more than the highest page that has ever been allocated */
+  page_id_t GetNextPageId();
+
+  /** @return the number of free pages below the high-water mark */
+  int64_t GetNumFreePages();
+
+  /**
+   * Writes the map pages that changed since the last Flush and the header, then syncs the map file.
+   * @return false on an I/O error
+   */
+  bool Flush();
+
+ private:
+  /** Identifies a map file: "BFSM" followed by a format version. */
+  static constexpr uint32_t MAGIC = 0x4D534642;
+  static constexpr uint32_t VERSION = 1;
+  static constexpr int64_t WORDS_PER_PAGE = BITS_PER_PAGE / 64;
+
+  struct Header {
+    uint32_t magic_;
+    uint32_t version_;
+    int64_t next_page_id_;
+  };
+
+  bool IsFree(int64_t page_id) const {
+    return page_id >= next_page_id_ || (words_[page_id / 64] & (uint64_t{1} << (page_id % 64))) == 0;
+  }
+
+  /** @return the first page id at or after from that is residue modulo stride */
+  static int64_t FirstCandidate(int64_t from, uint32_t stride, uint32_t residue);
+
+  /** @return the first free candidate page in [from, to), or INVALID_PAGE_ID. Requires latch_. */
+  int64_t FindFree(int64_t from, int64_t to, uint32_t stride, uint32_t residue) const;
+
+  /**
+   * @return the first candidate page of the first entirely free extent, possibly above next_page_id_. Moves
+   * first_free_extent_ up to the first entirely free extent it passes. Requires latch_.
+   */
+  int64_t FindFreeExtent(uint32_t stride, uint32_t residue);
+
+  /**
+   * @return the page below which no candidate page of the residue class is free; resets the cursors of all classes
+   * if the stride differs from that of the previous call. Requires latch_.
+   */
+  int64_t &ResidueCursor(uint32_t stride, uint32_t residue);
+
+  /** Sets the bit of a free page, raising the high-water mark if needed. Requires latch_. */
+  void MarkAllocated(int64_t page_id);
+
+  /** Grows words_ and dirty_ to cover the pages below num_pages. Requires latch_. */
+  void Reserve(int64_t num_pages);
+
+  /** Reads the header and the map pages from the file. Requires latch_. */
+  void Load(int64_t num_pages_in_file);
+
+  std::string file_name_;
+  /** The map file, or -1 while it does not exist. */
+  int fd_{-1};
+  std::vector<uint64_t> words_;
+  /** dirty_[k] is true if map page k + 1 changed since the last Flush. */
+  std::vector<bool> dirty_;
+  bool header_dirty_{false};
+  int64_t next_page_id_{0};
+  int64_t num_free_{0};
+  /** No page below this one is free. */
+  int64_t first_free_{0};
+  /** No extent below the one that starts here is entirely free. */
+  int64_t first_free_extent_{0};
+  /** The stride of the allocations without a hint, which is the number of instances of a ParallelBufferPoolManager. */
+  uint32_t cursor_stride_{0};
+  /** first_free_by_residue_[r]: no page below it that is r modulo cursor_stride_ is free. */
+  std::vector<int64_t> first_free_by_residue_;
+  /** Protects everything above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
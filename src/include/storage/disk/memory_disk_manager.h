@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_disk_manager.h
+//
+// Identification: src/include/storage/disk/memory_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * MemoryDiskManager keeps the pages and the log of a database in memory, so that the buffer pool and the access
+ * methods can be benchmarked and tested without a device. Pages are stored sparsely: only pages that have been written
+ * take up memory, and all others read as zeroes, like the pages past the end of a database file. Everything is lost
+ * when the MemoryDiskManager is destroyed; syncs only count.
+ */
+class MemoryDiskManager : public DiskManager {
+ public:
+  MemoryDiskManager() = default;
+
+  ~MemoryDiskManager() override = default;
+
+  void ShutDown() override {}
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void SyncDataFile() override;
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int64_t offset) override;
+
+  /** Buffer pool snapshots are not kept, since there is nothing to warm up from after a restart. */
+  bool WriteSnapshot(const std::vector<page_id_t> &page_ids) override { return false; }
+
+  bool ReadSnapshot(std::vector<page_id_t> *page_ids) override {
+    page_ids->clear();
+    return false;
+  }
+
+  /** @return the number of pages that have been written, i.e. that take up memory */
+  size_t GetNumPages();
+
+ private:
+  std::unordered_map<page_id_t, std::unique_ptr<char[]>> pages_;
+  /** Protects pages_ and the content of the pages. */
+  ReaderWriterLatch pages_latch_;
+  std::vector<char> log_;
+  /** Protects log_. */
+  std::mutex log_latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_extent_map.h
+//
+// Identification: src/include/storage/disk/page_extent_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Where a page of a compressed database is stored, see PageExtentMap. */
+struct PageExtent {
+  /** Byte offset of the extent in the database file. */
+  int64_t offset_{0};
+  /**
+   * Number of sectors of the extent: 0 for a page of zeroes, which takes none, PageExtentMap::RAW_SECTORS for a page
+   * that is stored as it is, and fewer for a compressed page.
+   */
+  int64_t sectors_{0};
+};
+
+/**
+ * PageExtentMap records where DiskManager stores the pages of a compressed database, whose pages take a variable
+ * number of SECTOR_SIZE sectors of the database file each, and manages the sectors.
+ *
+ * A page that is rewritten with the same number of sectors stays in its extent, so that its extent is valid with the
+ * old and the new map alike. Otherwise it moves to a new extent, and the old one only becomes free at the next Flush:
+ * until the new map is durable, the map on disk may still refer to it. Free sectors are kept in lists of runs by
+ * length, and a page takes the shortest run that fits or else grows the file.
+ *
+ * The map lives in a file of its own next to the database file, like FreeSpaceMap: page 0 of that file is a header,
+ * page k + 1 holds the extents of database pages [k * ENTRIES_PER_PAGE, (k + 1) * ENTRIES_PER_PAGE). Flush writes the
+ * map pages that changed, so after a crash the map is as of the last sync. The free sectors are not stored; they are
+ * the gaps between the extents.
+ */
+class PageExtentMap {
+ public:
+  /** The unit in which the database file is allocated. */
+  static constexpr int64_t SECTOR_SIZE = 512;
+  /** The sectors of a page that is stored as it is. */
+  static constexpr int64_t RAW_SECTORS = PAGE_SIZE / SECTOR_SIZE;
+  /** Number of extents that fit into one page of the map file. */
+  static constexpr int64_t ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(PageExtent);
+
+  /**
+   * Loads the map from its file. The file is only created by the first Flush that has something to write.
+   * @param file_name the name of the map file; if empty, the map is kept in memory only
+   */
+  explicit PageExtentMap(const std::string &file_name);
+
+  /** Closes the map file without flushing it. */
+  ~PageExtentMap();
+
+  DISALLOW_COPY_AND_MOVE(PageExtentMap);
+
+  /** @return the extent of a page; a page that was never written has no sectors, like a page of zeroes */
+  PageExtent Lookup(page_id_t page_id);
+
+  /**
+   * Finds the place for a new version of a page: its current extent if that has the right size, or else a new one.
+   * @param page_id the page to store
+   * @param sectors the sectors that the page takes, see PageExtent::sectors_
+   * @return the extent to write the page to
+   */
+  PageExtent Assign(page_id_t page_id, int64_t sectors);
+
+  /** @return one more than the highest page that has an extent or ever had one */
+  int64_t GetNumPages();
+
+  /** @return the number of bytes that the extents of all pages take up, free sectors excluded */
+  int64_t GetNumStoredBytes();
+
+  /**
+   * Writes the map pages that changed since the last Flush and the header, then syncs the map file, and finally frees
+   * the sectors that were given up since. The pages must have been synced before.
+   * @return false on an I/O error, in which case no sectors are freed
+   */
+  bool Flush();
+
+ private:
+  /** Identifies a map file: "BPXM" followed by a format version. */
+  static constexpr uint32_t MAGIC = 0x4D585042;
+  static constexpr uint32_t VERSION = 1;
+  struct Header {
+    uint32_t magic_;
+    uint32_t version_;
+    int64_t num_pages_;
+    int64_t page_size_;
+  };
+
+  /** A run of free sectors. */
+  struct Run {
+    int64_t offset_;
+    int64_t sectors_;
+  };
+
+  /** @return the offset of a run of sectors, taken from the free lists or from the end of the file. Requires latch_. */
+  int64_t AllocateSectors(int64_t sectors);
+
+  /** Adds a run of free sectors to its list, split into runs that a page can use. Requires latch_. */
+  void FreeSectors(int64_t offset, int64_t sectors);
+
+  /** Grows extents_ and dirty_ to cover the pages below num_pages. Requires latch_. */
+  void Reserve(int64_t num_pages);
+
+  /** Reads the header and the map pages from the file, and finds the free sectors. Requires latch_. */
+  void Load();
+
+  std::string file_name_;
+  /** The map file, or -1 while it does not exist. */
+  int fd_{-1};
+  std::vector<PageExtent> extents_;
+  /** dirty_[k] is true if map page k + 1 changed since the last Flush. */
+  std::vector<bool> dirty_;
+  bool header_dirty_{false};
+  /** One more than the highest page that has an extent, or had one since the map was created. */
+  int64_t num_pages_{0};
+  /** free_runs_[n] holds runs of exactly n free sectors. */
+  std::vector<std::vector<int64_t>> free_runs_;
+  /** Runs that are given up, but that the map on disk may still refer to until the next Flush. */
+  std::vector<Run> pending_free_;
+  /** The end of the allocated part of the database file. */
+  int64_t end_{0};
+  int64_t stored_bytes_{0};
+  /** Protects everything above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_latency_disk_manager.h
+//
+// Identification: src/include/storage/disk/simulated_latency_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** The device that a SimulatedLatencyDiskManager pretends to be. Zero means no delay, or no limit. */
+struct SimulatedLatencyOptions {
+  /** Time from issuing a page read until it completes, on top of the transfer time. */
+  std::chrono::microseconds read_latency{0};
+  /** Time from issuing a page write until it completes, on top of the transfer time. */
+  std::chrono::microseconds write_latency{0};
+  /** Time that SyncDataFile takes. */
+  std::chrono::microseconds sync_latency{0};
+  /** Bytes per second that the device transfers, shared by all reads and writes. */
+  uint64_t bandwidth{0};
+};
+
+/**
+ * SimulatedLatencyDiskManager makes another disk manager, typically a MemoryDiskManager, behave like a slower device.
+ * Every page read and write first waits for its share of the bandwidth, then for the latency of the operation. Like on
+ * a real device, the latencies of concurrent requests overlap, whereas the bandwidth is one queue that all requests
+ * take turns in. The log is passed through without delay. The wrapped disk manager must outlive this one.
+ */
+class SimulatedLatencyDiskManager : public DiskManager {
+ public:
+  /**
+   * @param disk_manager the disk manager that does the actual I/O
+   * @param options the latencies and bandwidth to simulate
+   */
+  SimulatedLatencyDiskManager(DiskManager *disk_manager, const SimulatedLatencyOptions &options);
+
+  ~SimulatedLatencyDiskManager() override = default;
+
+  void ShutDown() override { disk_manager_->ShutDown(); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void SyncDataFile() override;
+
+  void WriteLog(char *log_data, int size) override { disk_manager_->WriteLog(log_data, size); }
+
+  bool ReadLog(char *log_data, int size, int64_t offset) override {
+    return disk_manager_->ReadLog(log_data, size, offset);
+  }
+
+  page_id_t AllocatePage(page_id_t near_page_id = INVALID_PAGE_ID, uint32_t stride = 1,
+                         uint32_t residue = 0) override {
+    return disk_manager_->AllocatePage(near_page_id, stride, residue);
+  }
+
+  void DeallocatePage(page_id_t page_id) override { disk_manager_->DeallocatePage(page_id); }
+
+  bool IsPageAllocated(page_id_t page_id) override { return disk_manager_->IsPageAllocated(page_id); }
+
+  bool WriteSnapshot(const std::vector<page_id_t> &page_ids) override {
+    return disk_manager_->WriteSnapshot(page_ids);
+  }
+
+  bool ReadSnapshot(std::vector<page_id_t> *page_ids) override { return disk_manager_->ReadSnapshot(page_ids); }
+
+  int GetNumFlushes() const override { return disk_manager_->GetNumFlushes(); }
+
+  bool GetFlushState() const override { return disk_manager_->GetFlushState(); }
+
+  int GetNumWrites() const override { return disk_manager_->GetNumWrites(); }
+
+  int GetNumSyncs() const override { return disk_manager_->GetNumSyncs(); }
+
+  int GetNumChecksumFailures() const override { return disk_manager_->GetNumChecksumFailures(); }
+
+ private:
+  /** Waits until the device has transferred one page and the latency has passed. */
+  void Delay(std::chrono::microseconds latency);
+
+  DiskManager *disk_manager_;
+  const SimulatedLatencyOptions options_;
+  /** Time that it takes to transfer one page at the configured bandwidth. */
+  const std::chrono::nanoseconds transfer_time_;
+  /** When the device is done with the transfers that have been queued so far. */
+  std::chrono::steady_clock::time_point device_free_;
+  /** Protects device_free_. */
+  std::mutex device_latch_;
+};
+
+}  // namespace bustub
@@ -18,6 +18,7 @@
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -39,8 +40,11 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // If swizzle_children is set, descents follow child references through BufferPoolManager::FetchChildPage, which
+  // skips the page table for children that are still in the frame in which they were last found.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool swizzle_children = false);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -77,7 +81,7 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  Page *FindLeafPage(const KeyType &key, bool leftMost = false);
+  ReadPageGuard FindLeafPage(const KeyType &key, bool leftMost = false);
   Page *FindLeafPage(const KeyType &key, BPlusTreeOpType op_type, Transaction *transaction);
   void UnlockAncestorPages(bool is_dirty, Transaction *transaction);
 
@@ -104,6 +108,9 @@ class BPlusTree {
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  // Fetch the child at index of the internal page held by the pinned page parent.
+  Page *FetchChildPage(Page *parent, const InternalPage *inner, int index);
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -118,6 +125,7 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool swizzle_children_;
   ReaderWriterLatch latch_;
 };
 
@@ -42,6 +42,7 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ * With 64-bit page ids (BUSTUB_PAGE_ID_64), both page ids take 8 bytes, 32 bytes in total.
  */
 class BPlusTreePage {
  public:
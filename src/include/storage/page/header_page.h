@@ -25,6 +25,7 @@ namespace bustub {
  *  -----------------------------------------------------------------
  * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
  *  -----------------------------------------------------------------
+ * With 64-bit page ids (BUSTUB_PAGE_ID_64), the root ids take 8 bytes.
  */
 class HeaderPage : public Page {
  public:
@@ -41,6 +42,10 @@ class HeaderPage : public Page {
   int GetRecordCount();
 
  private:
+  static constexpr int OFFSET_RECORDS = 4;
+  static constexpr int NAME_SIZE = 32;
+  static constexpr int RECORD_SIZE = NAME_SIZE + sizeof(page_id_t);
+
   /**
    * helper functions
    */
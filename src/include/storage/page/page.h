@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <new>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,17 +27,33 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The data itself is not stored inline. A buffer pool keeps the data of all its frames in a FrameArena and the Pages
+ * in a separate array, each Page on its own cache lines, so that latching and pinning one frame does not invalidate
+ * the cache lines of its neighbours. A Page that is created on its own allocates its data.
+ *
+ * Page layouts only use the first PAGE_USABLE_SIZE bytes of the data. The trailer of PAGE_CHECKSUM_SIZE bytes belongs
+ * to DiskManager, which stores a checksum of the rest of the page there when it writes the page.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
-
-  /** Default destructor. */
-  ~Page() = default;
+  /** Constructor. Allocates and zeros out the page data, aligned like the frames of a FrameArena. */
+  Page()
+      : data_(static_cast<char *>(::operator new[](PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT}))),
+        owns_data_(true) {
+    ResetMemory();
+  }
+
+  /** Destructor. Frees the page data if this page allocated it. */
+  ~Page() {
+    if (owns_data_) {
+      ::operator delete[](data_, std::align_val_t{DIRECT_IO_ALIGNMENT});
+    }
+    delete swizzle_table_.load();
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
@@ -42,8 +61,8 @@ class Page {
   /** @return the page id of this page */
   inline page_id_t GetPageId() { return page_id_; }
 
-  /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  /** @return the pin count of this page; 0 for a frame that holds no page */
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -67,7 +86,6 @@ class Page {
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
  protected:
-  static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
 
   static constexpr size_t SIZE_PAGE_HEADER = 8;
@@ -75,19 +93,68 @@ class Page {
   static constexpr size_t OFFSET_LSN = 4;
 
  private:
+  /** Enough slots for the children of the B+ tree internal page with the smallest entries: 4-byte keys and values. */
+  static constexpr size_t SWIZZLE_SLOTS = PAGE_SIZE / (2 * sizeof(page_id_t));
+
+  /**
+   * Swizzled child references of a B+ tree internal page: children_[i] is the frame in which child i was found the
+   * last time it was fetched through BufferPoolManager::FetchChildPage. The pointers are hints that are validated on
+   * every use, so they need not be kept in sync with the page content.
+   */
+  struct SwizzleTable {
+    std::atomic<Page *> children_[SWIZZLE_SLOTS];
+  };
+
+  /**
+   * Constructor for a buffer pool frame. Zeros out the page data.
+   * @param data the frame's data in the buffer pool's arena, which outlives the page
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) { ResetMemory(); }
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** @return the swizzle table, which is allocated by the first caller. Requires a pin. */
+  SwizzleTable *GetSwizzleTable() {
+    SwizzleTable *table = swizzle_table_.load(std::memory_order_acquire);
+    if (table == nullptr) {
+      auto *fresh = new SwizzleTable();
+      if (swizzle_table_.compare_exchange_strong(table, fresh, std::memory_order_acq_rel)) {
+        table = fresh;
+      } else {
+        delete fresh;
+      }
+    }
+    return table;
+  }
+
+  /** Unswizzles all child references, for a frame that is being recycled and thus is nobody's parent any more. */
+  void Unswizzle() {
+    SwizzleTable *table = swizzle_table_.load(std::memory_order_relaxed);
+    if (table != nullptr) {
+      for (auto &child : table->children_) {
+        child.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /** The actual data that is stored within a page, PAGE_SIZE bytes. */
+  char *data_;
+  /** True if data_ was allocated by this page. */
+  bool owns_data_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /**
+   * The pin count of this page. The buffer pool pins pages without its latch, and uses -1 for frames that must not be
+   * pinned because they hold no page or are being recycled.
+   */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** The swizzled child references if this frame has been the parent in a FetchChildPage, nullptr otherwise. */
+  std::atomic<SwizzleTable *> swizzle_table_{nullptr};
 };
 
 }  // namespace bustub
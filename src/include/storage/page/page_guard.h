@@ -0,0 +1,238 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds the pin on a page and unpins it when it goes out of scope or is dropped. The page is unpinned
+ * dirty exactly if it was accessed through one of the mutable accessors or MarkDirty() was called.
+ *
+ * Guards are move-only. A guard that has been moved from, dropped, or that wraps a failed fetch holds no page; see
+ * IsValid().
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  /** Takes over the pin of that, which is left empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Drops the page held by this guard, then takes over the pin of that, which is left empty. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  /** Drops the page, if any. */
+  ~BasicPageGuard();
+
+  /** Unpins the page, dirty if it has been modified through this guard, and empties the guard. */
+  void Drop();
+
+  /**
+   * Latches the page for reading and hands the pin over to a ReadPageGuard. This guard is left empty.
+   * @return the read guard
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Latches the page for writing and hands the pin over to a WritePageGuard. This guard is left empty.
+   * @return the write guard
+   */
+  WritePageGuard UpgradeWrite();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the content of the page, for reading */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the content of the page, for writing; the page will be unpinned dirty */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the content of the page interpreted as T, for reading */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the content of the page interpreted as T, for writing; the page will be unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /**
+   * For page types that derive from Page, such as TablePage and HeaderPage. Their accessors are not const-qualified, so
+   * this does not mark the page dirty; call MarkDirty() or use AsPageMut() when modifying it.
+   * @return the page as T
+   */
+  template <class T>
+  T *AsPage() const {
+    return static_cast<T *>(page_);
+  }
+
+  /** @return the page as T, for writing; the page will be unpinned dirty */
+  template <class T>
+  T *AsPageMut() {
+    is_dirty_ = true;
+    return static_cast<T *>(page_);
+  }
+
+  /** Makes the page be unpinned dirty. */
+  void MarkDirty() { is_dirty_ = true; }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch on a page. Dropping it releases the latch, then the pin.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /** Wraps a page that is already pinned and read-latched. */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** Drops the page held by this guard, then takes over the latch and pin of that, which is left empty. */
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  /** Drops the page, if any. */
+  ~ReadPageGuard();
+
+  /** Releases the read latch and the pin, and empties the guard. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the content of the page */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the content of the page interpreted as T */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the page as T, for page types that derive from Page; see BasicPageGuard::AsPage() */
+  template <class T>
+  T *AsPage() const {
+    return guard_.AsPage<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch on a page. Dropping it releases the latch, then the pin.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /** Wraps a page that is already pinned and write-latched. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** Drops the page held by this guard, then takes over the latch and pin of that, which is left empty. */
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  /** Drops the page, if any. */
+  ~WritePageGuard();
+
+  /** Releases the write latch and the pin, and empties the guard. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  bool IsValid() const { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the content of the page, for reading */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the content of the page, for writing; the page will be unpinned dirty */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** @return the content of the page interpreted as T, for reading */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the content of the page interpreted as T, for writing; the page will be unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  /** @return the page as T, for page types that derive from Page; see BasicPageGuard::AsPage() */
+  template <class T>
+  T *AsPage() const {
+    return guard_.AsPage<T>();
+  }
+
+  /** @return the page as T, for writing; the page will be unpinned dirty */
+  template <class T>
+  T *AsPageMut() {
+    return guard_.AsPageMut<T>();
+  }
+
+  /** Makes the page be unpinned dirty. */
+  void MarkDirty() { guard_.MarkDirty(); }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
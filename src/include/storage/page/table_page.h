@@ -40,6 +40,11 @@ namespace bustub {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ *  With 64-bit page ids (BUSTUB_PAGE_ID_64) the LSN stays at offset 4, where every page keeps it, so the header
+ *  starts with 4 unused bytes and the 8-byte page ids follow the LSN:
+ *  ------------------------------------------------------------------------------------------------
+ *  | Unused (4)| LSN (4)| PageId (8)| PrevPageId (8)| NextPageId (8)| FreeSpacePointer(4) | ... |
+ *  ------------------------------------------------------------------------------------------------
  */
 class TablePage : public Page {
  public:
@@ -54,7 +59,7 @@ class TablePage : public Page {
   void Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager, Transaction *txn);
 
   /** @return the page ID of this table page */
-  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PAGE_ID); }
 
   /** @return the page ID of the previous table page */
   page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
@@ -138,16 +143,17 @@ class TablePage : public Page {
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
  private:
-  static_assert(sizeof(page_id_t) == 4);
-
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static_assert(sizeof(page_id_t) == 4 || sizeof(page_id_t) == 8);
+
+  static constexpr size_t OFFSET_PAGE_ID = sizeof(page_id_t) == 4 ? 0 : SIZE_PAGE_HEADER;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = sizeof(page_id_t) == 4 ? SIZE_PAGE_HEADER : OFFSET_PAGE_ID + 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = OFFSET_PREV_PAGE_ID + sizeof(page_id_t);
+  static constexpr size_t OFFSET_FREE_SPACE = OFFSET_NEXT_PAGE_ID + sizeof(page_id_t);
+  static constexpr size_t OFFSET_TUPLE_COUNT = OFFSET_FREE_SPACE + 4;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = OFFSET_TUPLE_COUNT + 4;
   static constexpr size_t SIZE_TUPLE = 8;
-  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-  static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = SIZE_TABLE_PAGE_HEADER;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = OFFSET_TUPLE_OFFSET + 4;
 
   /** @return pointer to the end of the current free space, see header comment */
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
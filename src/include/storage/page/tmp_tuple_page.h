@@ -25,9 +25,6 @@ class TmpTuplePage : public Page {
   page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
 
   bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
-
- private:
-  static_assert(sizeof(page_id_t) == 4);
 };
 
 }  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -99,6 +101,17 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read several tuples from the table. The pages are fetched as one batch and every page is latched once for all of
+   * its tuples, which is cheaper than calling GetTuple for each rid. A page that the batch finds no frame for is
+   * fetched on its own once the pages before it are done with, so a batch may span more pages than the pool holds.
+   * @param rids rids of the tuples to read, in any order
+   * @param[out] tuples the tuples, in the order of rids
+   * @param txn transaction performing the read
+   * @return true if every read was successful
+   */
+  bool GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -13,7 +13,9 @@
 #pragma once
 
 #include <cassert>
+#include <deque>
 
+#include "common/config.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -24,6 +26,10 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * Whenever the iterator moves to a new page, it asks the buffer pool to read ahead up to SCAN_READAHEAD_PAGES pages
+ * along the next_page_id chain, so that the disk reads overlap with the processing of the current page. The id of a
+ * page's successor is only known once the page itself is in memory, so the window grows as read-ahead pages arrive.
  */
 class TableIterator {
   friend class Cursor;
@@ -32,7 +38,11 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        readahead_page_id_(other.readahead_page_id_),
+        readahead_(other.readahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +62,26 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    readahead_page_id_ = other.readahead_page_id_;
+    readahead_ = other.readahead_;
     return *this;
   }
 
  private:
+  /**
+   * Extends the read-ahead window after the iterator has moved to a new page.
+   * @param page_id the page the iterator is on
+   * @param next_page_id the successor of that page
+   */
+  void ReadAhead(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The page for which ReadAhead was last called. */
+  page_id_t readahead_page_id_{INVALID_PAGE_ID};
+  /** Pages after the current one that have been handed to PrefetchPages, in chain order. */
+  std::deque<page_id_t> readahead_;
 };
 
 }  // namespace bustub
@@ -12,43 +12,195 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
- * The flush can be triggered when timeout or the log buffer is full or buffer
- * pool manager wants to force flush (it only happens when the flushed page has
- * a larger LSN than persistent LSN)
+ * The flush can be triggered when timeout or the log buffer is full or a
+ * committing transaction (or anyone else) calls Flush
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock guard(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  stop_ = false;
+  enable_logging = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
+ * The records that are still buffered are written first
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock guard(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    enable_logging = false;
+    stop_ = true;
+    flush_thread = std::exchange(flush_thread_, nullptr);
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+}
 
 /*
  * append a log record into log buffer
- * you MUST set the log record's lsn within this method
+ * the record's lsn is set here, together with its place in the buffer, so that lsns follow the order in the buffer
  * @return: lsn that is assigned to this log record
  *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
+ * a record that does not fit wakes the flush thread, and waits for the swap
+ */
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  BUSTUB_ASSERT(log_record->GetSize() <= LOG_BUFFER_SIZE, "A log record must fit into the log buffer.");
+  const auto size = static_cast<uint64_t>(log_record->GetSize());
+  while (true) {
+    const uint64_t reservation = reservation_.fetch_add(LSN_ONE + size);
+    const uint64_t offset = OffsetOf(reservation);
+    if (offset + size <= LOG_BUFFER_SIZE) {
+      log_record->lsn_ = LsnOf(reservation);
+      SerializeLogRecord(log_record, log_buffer_ + offset);
+      copied_.fetch_add(size, std::memory_order_release);
+      return log_record->lsn_;
+    }
+    // Only the first reservation that does not fit starts within the buffer; the ones after it see it sealed.
+    if (offset <= LOG_BUFFER_SIZE) {
+      seal_.store(reservation);
+    }
+    WaitForSwap();
+  }
+}
+
+/*
+ * commits that come in while a write is in progress all wait for the next one, which is how they end up in one sync
+ */
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  while (persistent_lsn_ < std::min(lsn, GetNextLSN() - 1)) {
+    if (flush_thread_ == nullptr) {
+      FlushBuffer(&lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::WaitForSwap() {
+  std::unique_lock lock(latch_);
+  while (OffsetOf(reservation_) > LOG_BUFFER_SIZE) {
+    if (flush_thread_ == nullptr) {
+      FlushBuffer(&lock);
+      continue;
+    }
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock lock(latch_);
+  while (!stop_ || OffsetOf(reservation_) > 0) {
+    cv_.wait_for(lock, log_timeout, [this] { return stop_ || flush_requested_; });
+    flush_requested_ = false;
+    FlushBuffer(&lock);
+  }
+}
+
+/*
+ * the records of one buffer are written while the next buffer fills up; a second write has to wait for the first,
+ * since it is the first's buffer that it swaps in
+ */
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> *lock) {
+  while (flushing_) {
+    flushed_cv_.wait(*lock);
+  }
+  if (OffsetOf(reservation_) == 0) {
+    return;
+  }
+  // Seal the buffer. If a record that did not fit has sealed it already, its reservation tells where the buffer ends.
+  uint64_t seal = reservation_.fetch_add(LOG_BUFFER_SIZE + 1);
+  if (OffsetOf(seal) > LOG_BUFFER_SIZE) {
+    while ((seal = seal_.exchange(NO_SEAL)) == NO_SEAL) {
+      std::this_thread::yield();
+    }
+  }
+  const uint64_t size = OffsetOf(seal);
+  while (copied_.load(std::memory_order_acquire) != size) {
+    std::this_thread::yield();
+  }
+
+  std::swap(log_buffer_, flush_buffer_);
+  copied_ = 0;
+  const lsn_t lsn = LsnOf(seal) - 1;
+  reservation_ = static_cast<uint64_t>(LsnOf(seal)) * LSN_ONE;
+  flushing_ = true;
+  flushed_cv_.notify_all();
+  lock->unlock();
+  disk_manager_->WriteLog(flush_buffer_, static_cast<int>(size));
+  lock->lock();
+  flushing_ = false;
+  persistent_lsn_ = lsn;
+  flushed_cv_.notify_all();
+}
+
+/*
+ * First the header, size | LSN | transID | prevLSN | LogType, then the body of the record's type
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+void LogManager::SerializeLogRecord(LogRecord *log_record, char *data) {
+  int pos = 0;
+  memcpy(data + pos, &log_record->size_, sizeof(int32_t));
+  pos += sizeof(int32_t);
+  memcpy(data + pos, &log_record->lsn_, sizeof(lsn_t));
+  pos += sizeof(lsn_t);
+  memcpy(data + pos, &log_record->txn_id_, sizeof(txn_id_t));
+  pos += sizeof(txn_id_t);
+  memcpy(data + pos, &log_record->prev_lsn_, sizeof(lsn_t));
+  pos += sizeof(lsn_t);
+  memcpy(data + pos, &log_record->log_record_type_, sizeof(LogRecordType));
+  pos += sizeof(LogRecordType);
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(data + pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(data + pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(data + pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(data + pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(data + pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(data + pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(data + pos, &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
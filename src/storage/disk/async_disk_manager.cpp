@@ -0,0 +1,322 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "common/logger.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define BUSTUB_HAVE_IO_URING 1
+#else
+#define BUSTUB_HAVE_IO_URING 0
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Workers of the THREAD_POOL backend; more do not help against a single file on one device. */
+constexpr size_t THREAD_POOL_WORKERS = 4;
+
+}  // namespace
+
+AsyncDiskManager::AsyncDiskManager(DiskManager *disk_manager, size_t queue_depth, Backend backend)
+    : disk_manager_(disk_manager), queue_depth_(queue_depth), backend_(backend) {
+  BUSTUB_ASSERT(queue_depth > 0, "An AsyncDiskManager needs room for at least one request.");
+  // The ring works on the segment files, so disk managers that keep their pages elsewhere go through the pool.
+  if (backend_ == Backend::IO_URING && (!disk_manager_->IsFileBacked() || !SetUpRing())) {
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+    backend_ = Backend::THREAD_POOL;
+  }
+  if (backend_ == Backend::IO_URING) {
+    completion_thread_ = std::thread(&AsyncDiskManager::CompletionLoop, this);
+  } else {
+    for (size_t i = 0; i < std::min(queue_depth_, THREAD_POOL_WORKERS); ++i) {
+      workers_.emplace_back(&AsyncDiskManager::WorkerLoop, this);
+    }
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() {
+  WaitForAll();
+  if (backend_ == Backend::IO_URING) {
+    // A request without a page tells the completion thread to stop.
+    {
+      std::scoped_lock guard(submit_latch_);
+      SubmitToRing(nullptr);
+    }
+    completion_thread_.join();
+  } else {
+    {
+      std::scoped_lock guard(queue_latch_);
+      shutdown_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data, Callback callback) {
+  Submit(new Request{page_id, page_data, false, std::move(callback), {}});
+}
+
+void AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data, Callback callback) {
+  // The buffer is only ever read for a write.
+  Submit(new Request{page_id, const_cast<char *>(page_data), true, std::move(callback), {}});
+}
+
+std::future<bool> AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  ReadPageAsync(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return future;
+}
+
+std::future<bool> AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  WritePageAsync(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return future;
+}
+
+void AsyncDiskManager::WaitForAll() {
+  std::unique_lock lock(in_flight_latch_);
+  in_flight_cv_.wait(lock, [&] { return in_flight_ == 0; });
+}
+
+void AsyncDiskManager::Submit(Request *request) {
+  {
+    std::unique_lock lock(in_flight_latch_);
+    in_flight_cv_.wait(lock, [&] { return in_flight_ < queue_depth_; });
+    ++in_flight_;
+  }
+  if (backend_ == Backend::IO_URING) {
+    std::scoped_lock guard(submit_latch_);
+    SubmitToRing(request);
+  } else {
+    {
+      std::scoped_lock guard(queue_latch_);
+      queue_.push_back(request);
+    }
+    queue_cv_.notify_one();
+  }
+}
+
+void AsyncDiskManager::Complete(Request *request, bool success) {
+  request->callback_(success);
+  if (request->stamped_ != nullptr) {
+    ::operator delete[](request->stamped_, std::align_val_t{DIRECT_IO_ALIGNMENT});
+  }
+  delete request;
+  {
+    std::scoped_lock guard(in_flight_latch_);
+    --in_flight_;
+  }
+  in_flight_cv_.notify_all();
+}
+
+void AsyncDiskManager::WorkerLoop() {
+  std::unique_lock lock(queue_latch_);
+  while (true) {
+    queue_cv_.wait(lock, [&] { return shutdown_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    Request *request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    if (request->is_write_) {
+      disk_manager_->WritePage(request->page_id_, request->data_);
+    } else {
+      disk_manager_->ReadPage(request->page_id_, request->data_);
+    }
+    Complete(request, true);
+    lock.lock();
+  }
+}
+
+#if BUSTUB_HAVE_IO_URING
+
+bool AsyncDiskManager::SetUpRing() {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  const auto fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth_), &params));
+  if (fd < 0) {
+    return false;
+  }
+  ring_fd_ = fd;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  void *sq_ring =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    return false;
+  }
+  sq_ring_ = sq_ring;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void *cq_ring =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = cq_ring;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = sqes;
+  auto *sq = static_cast<char *>(sq_ring_);
+  auto *cq = static_cast<char *>(cq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  return true;
+}
+
+void AsyncDiskManager::SubmitToRing(Request *request) {
+  // Only submitters write the tail, and they hold submit_latch_. The kernel consumes the entry within the enter call
+  // below, so the queue never holds more than one entry and cannot overflow.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    sqe->opcode = IORING_OP_NOP;
+  } else if (!request->is_write_ &&
+             static_cast<int64_t>(request->page_id_) * PAGE_SIZE >= disk_manager_->db_file_size_) {
+    // Like DiskManager::ReadPage, do not look for pages that were never written, let alone create segments for them.
+    // A NOP completes with a result of 0, i.e. nothing read.
+    sqe->opcode = IORING_OP_NOP;
+  } else {
+    // READV and WRITEV work on every kernel that has io_uring at all, unlike READ and WRITE.
+    int fd;
+    int64_t offset;
+    disk_manager_->LocatePage(request->page_id_, &fd, &offset);
+    request->iov_.iov_base = request->data_;
+    if (request->is_write_ && disk_manager_->page_checksums_) {
+      request->stamped_ = static_cast<char *>(::operator new[](PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT}));
+      memcpy(request->stamped_, request->data_, PAGE_SIZE);
+      DiskManager::SetPageChecksum(request->stamped_);
+      request->iov_.iov_base = request->stamped_;
+    }
+    request->iov_.iov_len = PAGE_SIZE;
+    sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(offset);
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG_DEBUG("io_uring_enter failed while submitting");
+      break;
+    }
+  }
+}
+
+void AsyncDiskManager::CompletionLoop() {
+  bool stop = false;
+  while (!stop) {
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed while waiting");
+    }
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const auto &cqe = static_cast<io_uring_cqe *>(cqes_)[head & *cq_mask_];
+      auto *request = reinterpret_cast<Request *>(cqe.user_data);
+      const int result = cqe.res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (request == nullptr) {
+        stop = true;
+        continue;
+      }
+      bool success = result >= 0;
+      if (result == -EINVAL && disk_manager_->UsesDirectIO()) {
+        // Direct I/O rejected the buffer or the file; DiskManager knows how to work around either.
+        success = request->is_write_ ? disk_manager_->WriteFilePage(request->page_id_, request->data_)
+                                     : disk_manager_->ReadFilePage(request->page_id_, request->data_);
+      } else if (!success) {
+        LOG_DEBUG("I/O error in asynchronous %s: %s", request->is_write_ ? "write" : "read", strerror(-result));
+        if (!request->is_write_) {
+          // Like DiskManager::ReadPage, a failed read leaves zeroes rather than whatever the kernel got to.
+          memset(request->data_, 0, PAGE_SIZE);
+        }
+      } else if (!request->is_write_) {
+        // Like DiskManager::ReadPage, the part of the page beyond the end of the file reads as zeroes.
+        memset(request->data_ + result, 0, PAGE_SIZE - result);
+        if (disk_manager_->verify_checksums_) {
+          disk_manager_->VerifyPage(request->page_id_, request->data_);
+        }
+      } else if (result < PAGE_SIZE) {
+        // A short write is as rare as it is harmless to repeat; redo the page synchronously.
+        success = disk_manager_->WriteFilePage(request->page_id_, request->data_);
+      } else {
+        disk_manager_->num_writes_ += 1;
+        disk_manager_->ExtendFileSize(static_cast<int64_t>(request->page_id_) * PAGE_SIZE + PAGE_SIZE);
+      }
+      Complete(request, success);
+    }
+  }
+}
+
+#else
+
+bool AsyncDiskManager::SetUpRing() { return false; }
+
+void AsyncDiskManager::SubmitToRing(Request *request) {}
+
+void AsyncDiskManager::CompletionLoop() {}
+
+#endif
+
+}  // namespace bustub
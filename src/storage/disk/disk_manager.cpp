@@ -10,33 +10,120 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <new>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/crc32c.h"
+#include "common/util/lz4.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Identifies a buffer pool snapshot file: "BSNP" followed by a format version. */
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x504E5342;
+static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+/** Frees the buffers of ThreadPageBuffer. */
+struct AlignedDeleter {
+  void operator()(char *buffer) const { ::operator delete[](buffer, std::align_val_t{DIRECT_IO_ALIGNMENT}); }
+};
+
+/** @return true if direct I/O accepts the buffer as it is */
+static bool IsAligned(const char *buffer) { return reinterpret_cast<uintptr_t>(buffer) % DIRECT_IO_ALIGNMENT == 0; }
+
+/**
+ * @return a page buffer of the calling thread that direct I/O accepts, for pages that are not in such a buffer or
+ * that get a checksum
+ */
+static char *ThreadPageBuffer() {
+  thread_local std::unique_ptr<char[], AlignedDeleter> buffer(
+      static_cast<char *>(::operator new[](PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT})));
+  return buffer.get();
+}
+
+/**
+ * Switches a file to buffered I/O after the file system rejected a direct transfer with EINVAL.
+ * @return true if the file was using direct I/O, i.e. if the transfer is worth repeating
+ */
+static bool ClearDirectIO(int fd) {
+#ifdef O_DIRECT
+  const int flags = fcntl(fd, F_GETFL);
+  if (flags >= 0 && (flags & O_DIRECT) != 0 && fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+    LOG_DEBUG("direct I/O rejected, falling back to buffered I/O");
+    return true;
+  }
+#endif
+  return false;
+}
+
+/**
+ * Writes the buffers of an I/O vector at offset, repeating short writes.
+ * @return false on an I/O error
+ */
+static bool WriteVectorFully(int fd, std::vector<iovec> *iov, int64_t offset) {
+  size_t first = 0;
+  while (first < iov->size()) {
+    ssize_t n = pwritev(fd, iov->data() + first, static_cast<int>(iov->size() - first), offset);
+    if (n < 0) {
+      if (errno == EINTR || (errno == EINVAL && ClearDirectIO(fd))) {
+        continue;
+      }
+      return false;
+    }
+    offset += n;
+    // Skip what was written, which may end in the middle of a buffer.
+    for (; first < iov->size() && static_cast<size_t>(n) >= (*iov)[first].iov_len; ++first) {
+      n -= static_cast<ssize_t>((*iov)[first].iov_len);
+    }
+    if (first < iov->size()) {
+      (*iov)[first].iov_base = static_cast<char *>((*iov)[first].iov_base) + n;
+      (*iov)[first].iov_len -= n;
+    }
+  }
+  return true;
+}
+
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create the database file & log file, and open the segments that follow the database file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, const DiskManagerOptions &options)
+    : segment_size_(options.segment_size),
+      segment_dirs_(options.segment_dirs),
+      segment_fds_(std::make_unique<int[]>(MAX_SEGMENTS)),
+      file_name_(db_file),
+      direct_io_(options.direct_io && !options.compression),
+      page_checksums_(options.page_checksums),
+      verify_checksums_(options.page_checksums && options.verify_checksums) {
+  BUSTUB_ASSERT(segment_size_ > 0 && segment_size_ % PAGE_SIZE == 0, "Segments must hold whole pages.");
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
+    direct_io_ = false;
+    free_space_map_ = std::make_unique<FreeSpaceMap>("", 0);
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  snapshot_name_ = file_name_.substr(0, n) + ".snapshot";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -51,75 +138,263 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open dblog file");
     }
   }
+  // The stream cannot sync, so the log is synced through a descriptor of its own.
+  log_fd_ = open(log_name_.c_str(), O_WRONLY);
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  segment_fds_[0] = OpenSegment(db_file, O_RDWR | O_CREAT);
+  if (segment_fds_[0] < 0) {
+    throw Exception("can't open db file");
+  }
+#ifdef O_DIRECT
+  direct_io_ = direct_io_ && (fcntl(segment_fds_[0], F_GETFL) & O_DIRECT) != 0;
+#endif
+  // Segments are only ever created in order, so the existing ones are 0, 1, ... up to the first one that is missing.
+  // All but the last are considered full; the pages that were never written in them read as zeroes. A compressed
+  // database has one segment only, whose size says nothing about the number of pages.
+  int64_t num_segments = 1;
+  if (options.compression) {
+    file_backed_ = false;
+    extent_map_ = std::make_unique<PageExtentMap>(file_name_.substr(0, n) + ".pmap");
+  }
+  while (extent_map_ == nullptr && num_segments < MAX_SEGMENTS) {
+    const int fd = OpenSegment(GetSegmentFileName(num_segments), O_RDWR);
+    if (fd < 0) {
+      break;
     }
+    segment_fds_[num_segments++] = fd;
   }
+  struct stat stat_buf;
+  if (extent_map_ != nullptr) {
+    db_file_size_ = extent_map_->GetNumPages() * PAGE_SIZE;
+  } else if (fstat(segment_fds_[num_segments - 1], &stat_buf) == 0) {
+    db_file_size_ = (num_segments - 1) * segment_size_ + stat_buf.st_size;
+  }
+  num_segments_ = num_segments;
+  free_space_map_ =
+      std::make_unique<FreeSpaceMap>(file_name_.substr(0, n) + ".fsm", (db_file_size_ + PAGE_SIZE - 1) / PAGE_SIZE);
   buffer_used = nullptr;
 }
 
 /**
- * Close all file streams
+ * Constructor for subclasses: no files at all, and a free space map in memory
+ */
+DiskManager::DiskManager()
+    : segment_size_(DB_SEGMENT_SIZE), free_space_map_(std::make_unique<FreeSpaceMap>("", 0)), file_backed_(false) {}
+
+DiskManager::~DiskManager() {
+  for (int64_t segment = 0; segment < num_segments_; ++segment) {
+    close(segment_fds_[segment]);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
+/**
+ * Sync and close the segment files, and close the log stream
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  if (num_segments_ > 0) {
+    SyncDataFile();
+    std::scoped_lock guard(segment_latch_);
+    for (int64_t segment = 0; segment < num_segments_; ++segment) {
+      close(segment_fds_[segment]);
+    }
+    num_segments_ = 0;
+  }
   log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+}
+
+/**
+ * Segment 0 is the db file; the others are in the segment directories round robin, or next to the db file
+ */
+std::string DiskManager::GetSegmentFileName(int64_t segment) const {
+  if (segment == 0) {
+    return file_name_;
+  }
+  const std::string suffix = "." + std::to_string(segment);
+  if (segment_dirs_.empty()) {
+    return file_name_ + suffix;
+  }
+  const std::string::size_type slash = file_name_.rfind('/');
+  const std::string base_name = slash == std::string::npos ? file_name_ : file_name_.substr(slash + 1);
+  return segment_dirs_[(segment - 1) % segment_dirs_.size()] + "/" + base_name + suffix;
 }
 
 /**
- * Write the contents of the specified page into disk file
+ * Write the contents of the specified page into disk file. The write is positioned, so concurrent writers and readers
+ * of other pages do not interfere, and it goes to the OS without a sync; see SyncDataFile
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+void DiskManager::WritePage(page_id_t page_id, const char *page_data) { WriteFilePage(page_id, page_data); }
+
+bool DiskManager::WriteFilePage(page_id_t page_id, const char *page_data) {
+  if (extent_map_ != nullptr) {
+    num_writes_ += 1;
+    return WriteCompressedPage(page_id, page_data);
+  }
+  int fd;
+  int64_t offset;
+  LocatePage(page_id, &fd, &offset);
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  if (page_checksums_ || (direct_io_ && !IsAligned(page_data))) {
+    // The caller's page must not change, not even its trailer, so the checksum goes into a copy.
+    char *buffer = ThreadPageBuffer();
+    memcpy(buffer, page_data, PAGE_SIZE);
+    if (page_checksums_) {
+      SetPageChecksum(buffer);
+    }
+    page_data = buffer;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t n = pwrite(fd, page_data + written, PAGE_SIZE - written, offset + written);
+    if (n < 0) {
+      if (errno == EINTR || (errno == EINVAL && ClearDirectIO(fd))) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += n;
+  }
+  ExtendFileSize(static_cast<int64_t>(page_id) * PAGE_SIZE + PAGE_SIZE);
+  return true;
+}
+
+/**
+ * Group the pages into runs of consecutive pages within one segment and write each run with one pwritev. Pages that
+ * get a checksum, or that direct I/O does not accept as they are, go through copies, one scratch page per page of a run
+ */
+std::vector<bool> DiskManager::WritePages(const std::vector<page_id_t> &page_ids,
+                                          const std::vector<const char *> &pages) {
+  BUSTUB_ASSERT(page_ids.size() == pages.size(), "Every page needs its data.");
+  std::vector<bool> written(page_ids.size(), true);
+  if (!file_backed_) {
+    // Page by page; only a compressed database can tell whether a page made it, the others have no files to fail.
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      if (extent_map_ != nullptr) {
+        written[i] = WriteFilePage(page_ids[i], pages[i]);
+      } else {
+        WritePage(page_ids[i], pages[i]);
+      }
+    }
+    return written;
+  }
+  std::unique_ptr<char[], AlignedDeleter> scratch;
+  std::vector<iovec> iov;
+  iov.reserve(MAX_WRITE_RUN);
+  size_t begin = 0;
+  while (begin < page_ids.size()) {
+    int fd;
+    int64_t offset;
+    LocatePage(page_ids[begin], &fd, &offset);
+    size_t end = begin + 1;
+    while (end < page_ids.size() && end - begin < MAX_WRITE_RUN && page_ids[end] == page_ids[end - 1] + 1 &&
+           offset + static_cast<int64_t>(end - begin) * PAGE_SIZE < segment_size_) {
+      ++end;
+    }
+    iov.clear();
+    for (size_t i = begin; i < end; ++i) {
+      const char *page_data = pages[i];
+      if (page_checksums_ || (direct_io_ && !IsAligned(page_data))) {
+        if (scratch == nullptr) {
+          scratch.reset(static_cast<char *>(
+              ::operator new[](MAX_WRITE_RUN * PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT})));
+        }
+        char *buffer = scratch.get() + (i - begin) * PAGE_SIZE;
+        memcpy(buffer, page_data, PAGE_SIZE);
+        if (page_checksums_) {
+          SetPageChecksum(buffer);
+        }
+        page_data = buffer;
+      }
+      iov.push_back({const_cast<char *>(page_data), PAGE_SIZE});
+    }
+    num_writes_ += static_cast<int>(end - begin);
+    if (WriteVectorFully(fd, &iov, offset)) {
+      ExtendFileSize(static_cast<int64_t>(page_ids[end - 1]) * PAGE_SIZE + PAGE_SIZE);
+    } else {
+      LOG_DEBUG("I/O error while writing");
+      std::fill(written.begin() + begin, written.begin() + end, false);
+    }
+    begin = end;
+  }
+  return written;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+void DiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadFilePage(page_id, page_data); }
+
+bool DiskManager::ReadFilePage(page_id_t page_id, char *page_data) {
+  // The cached size spares a system call for pages that have never been written.
+  if (static_cast<int64_t>(page_id) * PAGE_SIZE >= db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  if (extent_map_ != nullptr) {
+    ReadCompressedPage(page_id, page_data);
+    if (verify_checksums_) {
+      VerifyPage(page_id, page_data);
+    }
+    return true;
+  }
+  int fd;
+  int64_t offset;
+  LocatePage(page_id, &fd, &offset);
+  char *buffer = direct_io_ && !IsAligned(page_data) ? ThreadPageBuffer() : page_data;
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t n = pread(fd, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (n < 0) {
+      if (errno == EINTR || (errno == EINVAL && ClearDirectIO(fd))) {
+        continue;
+      }
       LOG_DEBUG("I/O error while reading");
-      return;
+      memset(page_data, 0, PAGE_SIZE);
+      return false;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    if (n == 0) {
+      break;
     }
+    read_count += n;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (verify_checksums_) {
+    VerifyPage(page_id, buffer);
   }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  return true;
+}
+
+/**
+ * Make the page writes durable. Only the data is synced; the file size is metadata that fdatasync covers as well.
+ * The extent map and the allocation of pages are persisted after them
+ */
+void DiskManager::SyncDataFile() {
+  num_syncs_ += 1;
+  const int64_t num_segments = num_segments_;
+  for (int64_t segment = 0; segment < num_segments; ++segment) {
+    if (fdatasync(segment_fds_[segment]) != 0) {
+      LOG_DEBUG("I/O error while syncing");
+    }
+  }
+  if (extent_map_ != nullptr) {
+    extent_map_->Flush();
+  }
+  free_space_map_->Flush();
 }
 
 /**
@@ -153,6 +428,9 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
+  if (log_fd_ >= 0 && fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
   flush_log_ = false;
 }
 
@@ -161,7 +439,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
@@ -185,17 +463,113 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 }
 
 /**
- * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Write the snapshot as a header of magic, version and count, followed by the page ids
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+bool DiskManager::WriteSnapshot(const std::vector<page_id_t> &page_ids) {
+  if (snapshot_name_.empty()) {
+    return false;
+  }
+  const std::string tmp_name = snapshot_name_ + ".tmp";
+  {
+    std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+    const uint32_t header[3] = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, static_cast<uint32_t>(page_ids.size())};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+    out.flush();
+    if (!out.good()) {
+      LOG_DEBUG("I/O error while writing buffer pool snapshot");
+      remove(tmp_name.c_str());
+      return false;
+    }
+  }
+  return rename(tmp_name.c_str(), snapshot_name_.c_str()) == 0;
+}
+
+/**
+ * Read the snapshot back, dropping the pages that are not in the database file
+ */
+bool DiskManager::ReadSnapshot(std::vector<page_id_t> *page_ids) {
+  page_ids->clear();
+  const int64_t file_size = GetFileSize(snapshot_name_);
+  uint32_t header[3];
+  if (file_size < static_cast<int64_t>(sizeof(header))) {
+    return false;
+  }
+  std::ifstream in(snapshot_name_, std::ios::binary);
+  in.read(reinterpret_cast<char *>(header), sizeof(header));
+  if (!in.good() || header[0] != SNAPSHOT_MAGIC || header[1] != SNAPSHOT_VERSION ||
+      static_cast<size_t>(file_size) != sizeof(header) + static_cast<size_t>(header[2]) * sizeof(page_id_t)) {
+    LOG_DEBUG("ignoring damaged buffer pool snapshot");
+    return false;
+  }
+  page_ids->resize(header[2]);
+  in.read(reinterpret_cast<char *>(page_ids->data()), static_cast<std::streamsize>(header[2] * sizeof(page_id_t)));
+  if (!in.good()) {
+    page_ids->clear();
+    return false;
+  }
+  const auto num_pages = static_cast<page_id_t>(db_file_size_ / PAGE_SIZE);
+  page_ids->erase(std::remove_if(page_ids->begin(), page_ids->end(),
+                                 [&](page_id_t page_id) { return page_id < 0 || page_id >= num_pages; }),
+                  page_ids->end());
+  return true;
+}
+
+/**
+ * Allocate new page (operations like create index/table), preferring pages that have been deallocated
+ */
+page_id_t DiskManager::AllocatePage(page_id_t near_page_id, uint32_t stride, uint32_t residue) {
+  return free_space_map_->Allocate(near_page_id, stride, residue);
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  free_space_map_->Deallocate(page_id);
+  if (extent_map_ != nullptr && page_id >= 0) {
+    // The content of a deallocated page does not matter, so its sectors can go.
+    extent_map_->Assign(page_id, 0);
+  }
+}
+
+/**
+ * Returns number of pages with a wrong checksum read so far
+ */
+int DiskManager::GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+/**
+ * The checksum covers everything but the trailer, which holds it in little-endian byte order
+ */
+void DiskManager::SetPageChecksum(char *page_data) {
+  const uint32_t checksum = Crc32c::Value(page_data, PAGE_USABLE_SIZE);
+  for (int i = 0; i < PAGE_CHECKSUM_SIZE; ++i) {
+    page_data[PAGE_USABLE_SIZE + i] = static_cast<char>(checksum >> (8 * i));
+  }
+}
+
+/**
+ * Compare the stored checksum with a fresh one; only on a mismatch look for a page that was never written
+ */
+bool DiskManager::IsPageChecksumValid(const char *page_data) {
+  const uint32_t checksum = Crc32c::Value(page_data, PAGE_USABLE_SIZE);
+  uint32_t stored = 0;
+  for (int i = 0; i < PAGE_CHECKSUM_SIZE; ++i) {
+    stored |= static_cast<uint32_t>(static_cast<uint8_t>(page_data[PAGE_USABLE_SIZE + i])) << (8 * i);
+  }
+  return checksum == stored || std::all_of(page_data, page_data + PAGE_SIZE, [](char c) { return c == 0; });
+}
+
+/**
+ * A torn or corrupted page is reported, but not repaired; that is up to recovery
+ */
+void DiskManager::VerifyPage(page_id_t page_id, const char *page_data) {
+  if (!IsPageChecksumValid(page_data)) {
+    num_checksum_failures_ += 1;
+    LOG_WARN("checksum mismatch in page %s", std::to_string(page_id).c_str());
+  }
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,18 +581,168 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of data file syncs made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Publish a new end of the db file, unless a concurrent write has already extended it further
+ */
+void DiskManager::ExtendFileSize(int64_t end) {
+  int64_t size = db_file_size_.load();
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end)) {
+  }
+}
+
+/**
+ * Map a page to its segment, and create the segments up to it that do not exist yet
+ */
+void DiskManager::LocatePage(page_id_t page_id, int *fd, int64_t *offset) {
+  BUSTUB_ASSERT(page_id >= 0, "Pages on disk have non-negative ids.");
+  const int64_t db_offset = static_cast<int64_t>(page_id) * PAGE_SIZE;
+  const int64_t segment = db_offset / segment_size_;
+  *offset = db_offset % segment_size_;
+  if (segment < num_segments_.load(std::memory_order_acquire)) {
+    *fd = segment_fds_[segment];
+    return;
+  }
+  *fd = -1;
+  if (segment >= MAX_SEGMENTS) {
+    LOG_DEBUG("page is beyond the last possible segment");
+    return;
+  }
+  std::scoped_lock guard(segment_latch_);
+  for (int64_t next = num_segments_; next <= segment; ++next) {
+    const int next_fd = OpenSegment(GetSegmentFileName(next), O_RDWR | O_CREAT);
+    if (next_fd < 0) {
+      LOG_DEBUG("can't create segment file");
+      return;
+    }
+    segment_fds_[next] = next_fd;
+    num_segments_.store(next + 1, std::memory_order_release);
+  }
+  *fd = segment_fds_[segment];
+}
+
+/**
+ * Store a page of zeroes as no extent at all, a page that compresses well enough as the length of its LZ4 block
+ * followed by the block, and any other page as it is. The extent of a page tells which of the three it is
+ */
+bool DiskManager::WriteCompressedPage(page_id_t page_id, const char *page_data) {
+  BUSTUB_ASSERT(page_id >= 0, "Pages on disk have non-negative ids.");
+  const int64_t end = static_cast<int64_t>(page_id) * PAGE_SIZE + PAGE_SIZE;
+  if (std::all_of(page_data, page_data + PAGE_SIZE, [](char c) { return c == 0; })) {
+    extent_map_->Assign(page_id, 0);
+    ExtendFileSize(end);
+    return true;
+  }
+  if (page_checksums_) {
+    char *buffer = ThreadPageBuffer();
+    memcpy(buffer, page_data, PAGE_SIZE);
+    SetPageChecksum(buffer);
+    page_data = buffer;
+  }
+  char block[PAGE_SIZE];
+  uint32_t length = 0;
+  const size_t capacity = (PageExtentMap::RAW_SECTORS - 1) * PageExtentMap::SECTOR_SIZE - sizeof(length);
+  length = static_cast<uint32_t>(Lz4::Compress(page_data, PAGE_SIZE, block + sizeof(length), capacity));
+  const char *data = page_data;
+  size_t size = PAGE_SIZE;
+  if (length > 0) {
+    memcpy(block, &length, sizeof(length));
+    data = block;
+    size = sizeof(length) + length;
+  }
+  const PageExtent extent = extent_map_->Assign(
+      page_id, (static_cast<int64_t>(size) + PageExtentMap::SECTOR_SIZE - 1) / PageExtentMap::SECTOR_SIZE);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = pwrite(segment_fds_[0], data + written, size - written, extent.offset_ + written);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += n;
+  }
+  ExtendFileSize(end);
+  return true;
+}
+
+/**
+ * Only the bytes that were written of the last sector of an extent are in the file, so the file may end early
+ */
+void DiskManager::ReadCompressedPage(page_id_t page_id, char *page_data) {
+  const PageExtent extent = extent_map_->Lookup(page_id);
+  if (extent.sectors_ == 0) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  char block[PAGE_SIZE];
+  const bool raw = extent.sectors_ == PageExtentMap::RAW_SECTORS;
+  char *buffer = raw ? page_data : block;
+  const auto size = static_cast<size_t>(extent.sectors_ * PageExtentMap::SECTOR_SIZE);
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(segment_fds_[0], buffer + read_count, size - read_count, extent.offset_ + read_count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  if (raw) {
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    return;
+  }
+  uint32_t length = 0;
+  if (read_count >= sizeof(length)) {
+    memcpy(&length, block, sizeof(length));
+  }
+  if (read_count < sizeof(length) || length > read_count - sizeof(length) ||
+      !Lz4::Decompress(block + sizeof(length), length, page_data, PAGE_SIZE)) {
+    LOG_WARN("can't decompress page %s", std::to_string(page_id).c_str());
+    memset(page_data, 0, PAGE_SIZE);
+  }
+}
+
+/**
+ * Open with O_DIRECT if asked to, and without it if the file system refuses, which it signals with EINVAL
+ */
+int DiskManager::OpenSegment(const std::string &file_name, int flags) {
+#ifdef O_DIRECT
+  if (direct_io_) {
+    const int fd = open(file_name.c_str(), flags | O_DIRECT, 0644);
+    if (fd >= 0 || errno != EINVAL) {
+      return fd;
+    }
+    LOG_DEBUG("%s does not support direct I/O, falling back to buffered I/O", file_name.c_str());
+  }
+#endif
+  return open(file_name.c_str(), flags, 0644);
+}
+
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
@@ -0,0 +1,316 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+static_assert(64 % DB_EXTENT_SIZE == 0, "An extent must not straddle two words of the map.");
+
+namespace {
+
+/** Reads size bytes at offset. @return false on an I/O error or at the end of the file */
+bool ReadFully(int fd, char *data, size_t size, int64_t offset) {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(fd, data + read_count, size - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    read_count += n;
+  }
+  return true;
+}
+
+/** Writes size bytes at offset. @return false on an I/O error */
+bool WriteFully(int fd, const char *data, size_t size, int64_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = pwrite(fd, data + written, size - written, offset + written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+}  // namespace
+
+FreeSpaceMap::FreeSpaceMap(const std::string &file_name, int64_t num_pages_in_file) : file_name_(file_name) {
+  std::scoped_lock guard(latch_);
+  Load(num_pages_in_file);
+}
+
+FreeSpaceMap::~FreeSpaceMap() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+/**
+ * Pages that the file holds beyond the high-water mark of the map were allocated after the map was last flushed
+ */
+void FreeSpaceMap::Load(int64_t num_pages_in_file) {
+  int64_t map_pages = 0;
+  if (!file_name_.empty()) {
+    fd_ = open(file_name_.c_str(), O_RDWR);
+  }
+  if (fd_ >= 0 && num_pages_in_file > 0) {
+    Header header;
+    if (ReadFully(fd_, reinterpret_cast<char *>(&header), sizeof(header), 0) && header.magic_ == MAGIC &&
+        header.version_ == VERSION && header.next_page_id_ >= 0) {
+      Reserve(header.next_page_id_);
+      map_pages = header.next_page_id_;
+      for (size_t k = 0; k < dirty_.size(); ++k) {
+        if (!ReadFully(fd_, reinterpret_cast<char *>(&words_[k * WORDS_PER_PAGE]), PAGE_SIZE, (k + 1) * PAGE_SIZE)) {
+          LOG_DEBUG("ignoring damaged free space map");
+          map_pages = 0;
+          break;
+        }
+      }
+    } else {
+      LOG_DEBUG("ignoring damaged free space map");
+    }
+  }
+
+  // Trust the bits below the high-water mark of the map only, and count every page beyond it that the file holds.
+  next_page_id_ = std::max(map_pages, num_pages_in_file);
+  Reserve(next_page_id_);
+  std::fill(words_.begin() + (map_pages + 63) / 64, words_.end(), 0);
+  if (map_pages % 64 != 0) {
+    words_[map_pages / 64] &= (uint64_t{1} << (map_pages % 64)) - 1;
+  }
+  for (int64_t page_id = map_pages; page_id < next_page_id_; ++page_id) {
+    words_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+    dirty_[page_id / BITS_PER_PAGE] = true;
+  }
+  header_dirty_ = next_page_id_ != map_pages || num_pages_in_file == 0;
+
+  num_free_ = 0;
+  first_free_ = next_page_id_;
+  first_free_extent_ = 0;
+  cursor_stride_ = 0;
+  first_free_by_residue_.clear();
+  for (int64_t page_id = next_page_id_ - 1; page_id >= 0; --page_id) {
+    if (IsFree(page_id)) {
+      ++num_free_;
+      first_free_ = page_id;
+    }
+  }
+}
+
+page_id_t FreeSpaceMap::Allocate(page_id_t near_page_id, uint32_t stride, uint32_t residue) {
+  BUSTUB_ASSERT(stride > 0 && residue < stride, "The residue must be below the stride.");
+  std::scoped_lock guard(latch_);
+  int64_t page_id = INVALID_PAGE_ID;
+  if (near_page_id >= 0) {
+    // Keep going in the extent of the hint, which runs on past the high-water mark if the hint is the last page.
+    const int64_t extent_end = (near_page_id / DB_EXTENT_SIZE + 1) * DB_EXTENT_SIZE;
+    page_id = FindFree(near_page_id + 1, extent_end, stride, residue);
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = FindFreeExtent(stride, residue);
+    }
+  } else {
+    if (num_free_ > 0) {
+      // The free pages of the other residue classes would otherwise be scanned over again on every allocation.
+      int64_t &cursor = ResidueCursor(stride, residue);
+      page_id = FindFree(std::max(cursor, first_free_), next_page_id_, stride, residue);
+      cursor = page_id == INVALID_PAGE_ID ? next_page_id_ : page_id;
+      if (page_id != INVALID_PAGE_ID && stride == 1) {
+        first_free_ = page_id;
+      }
+    }
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = FirstCandidate(next_page_id_, stride, residue);
+    }
+  }
+  MarkAllocated(page_id);
+  return static_cast<page_id_t>(page_id);
+}
+
+void FreeSpaceMap::Deallocate(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  if (page_id < 0 || IsFree(page_id)) {
+    return;
+  }
+  words_[page_id / 64] &= ~(uint64_t{1} << (page_id % 64));
+  dirty_[page_id / BITS_PER_PAGE] = true;
+  ++num_free_;
+  first_free_ = std::min<int64_t>(first_free_, page_id);
+  first_free_extent_ = std::min<int64_t>(first_free_extent_, page_id / DB_EXTENT_SIZE * DB_EXTENT_SIZE);
+  if (cursor_stride_ > 0) {
+    int64_t &cursor = first_free_by_residue_[page_id % cursor_stride_];
+    cursor = std::min<int64_t>(cursor, page_id);
+  }
+}
+
+bool FreeSpaceMap::IsAllocated(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  return page_id >= 0 && !IsFree(page_id);
+}
+
+page_id_t FreeSpaceMap::GetNextPageId() {
+  std::scoped_lock guard(latch_);
+  return static_cast<page_id_t>(next_page_id_);
+}
+
+int64_t FreeSpaceMap::GetNumFreePages() {
+  std::scoped_lock guard(latch_);
+  return num_free_;
+}
+
+/**
+ * The map pages go first and the header last, so that a crash in between leaves the old high-water mark, below
+ * which every page still has a valid bit
+ */
+bool FreeSpaceMap::Flush() {
+  std::scoped_lock guard(latch_);
+  const bool any_dirty = std::find(dirty_.begin(), dirty_.end(), true) != dirty_.end();
+  if (file_name_.empty() || (!header_dirty_ && !any_dirty)) {
+    return true;
+  }
+  if (fd_ < 0) {
+    fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+      LOG_DEBUG("can't create free space map file");
+      return false;
+    }
+  }
+  for (size_t k = 0; k < dirty_.size(); ++k) {
+    if (!dirty_[k]) {
+      continue;
+    }
+    if (!WriteFully(fd_, reinterpret_cast<const char *>(&words_[k * WORDS_PER_PAGE]), PAGE_SIZE,
+                    (k + 1) * PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while writing free space map");
+      return false;
+    }
+    dirty_[k] = false;
+  }
+  char header_page[PAGE_SIZE] = {0};
+  const Header header{MAGIC, VERSION, next_page_id_};
+  memcpy(header_page, &header, sizeof(header));
+  if (!WriteFully(fd_, header_page, PAGE_SIZE, 0) || fdatasync(fd_) != 0) {
+    LOG_DEBUG("I/O error while writing free space map");
+    return false;
+  }
+  header_dirty_ = false;
+  return true;
+}
+
+int64_t FreeSpaceMap::FirstCandidate(int64_t from, uint32_t stride, uint32_t residue) {
+  const int64_t offset = (static_cast<int64_t>(residue) - from % stride + stride) % stride;
+  return from + offset;
+}
+
+int64_t FreeSpaceMap::FindFree(int64_t from, int64_t to, uint32_t stride, uint32_t residue) const {
+  int64_t page_id = FirstCandidate(from, stride, residue);
+  while (page_id < to) {
+    if (IsFree(page_id)) {
+      return page_id;
+    }
+    // Skip whole words of allocated pages.
+    const int64_t word = page_id / 64;
+    if (page_id < next_page_id_ && words_[word] == ~uint64_t{0}) {
+      page_id = FirstCandidate((word + 1) * 64, stride, residue);
+    } else {
+      page_id += stride;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+/**
+ * Every allocation with a hint that leaves its extent ends up here, so the scan starts at first_free_extent_ rather
+ * than at the lowest free page: a map with a free page in every extent would be scanned up to the high-water mark
+ * each time otherwise. An entirely free extent without a candidate for this residue may still have one for another,
+ * so the hint stops at the first entirely free extent, not at the one that is returned.
+ */
+int64_t FreeSpaceMap::FindFreeExtent(uint32_t stride, uint32_t residue) {
+  // The extent that holds the high-water mark may be free but for the pages below it, and stays ahead of the hint.
+  int64_t first_seen = next_page_id_ / DB_EXTENT_SIZE * DB_EXTENT_SIZE;
+  if (num_free_ >= DB_EXTENT_SIZE) {
+    const uint64_t extent_mask = (uint64_t{1} << DB_EXTENT_SIZE) - 1;
+    int64_t start = std::max(first_free_extent_, first_free_ / DB_EXTENT_SIZE * DB_EXTENT_SIZE);
+    for (; start < next_page_id_; start += DB_EXTENT_SIZE) {
+      // Bits at and above the high-water mark are zero, so an extent that straddles it is checked correctly.
+      const uint64_t word = words_[start / 64];
+      if (word == ~uint64_t{0}) {
+        start = start / 64 * 64 + 64 - DB_EXTENT_SIZE;
+        continue;
+      }
+      if ((word & (extent_mask << (start % 64))) != 0) {
+        continue;
+      }
+      first_seen = std::min(first_seen, start);
+      const int64_t page_id = FirstCandidate(start, stride, residue);
+      if (page_id < start + DB_EXTENT_SIZE) {
+        first_free_extent_ = first_seen;
+        return page_id;
+      }
+    }
+  }
+  first_free_extent_ = first_seen;
+  const int64_t end = (next_page_id_ + DB_EXTENT_SIZE - 1) / DB_EXTENT_SIZE * DB_EXTENT_SIZE;
+  return FirstCandidate(end, stride, residue);
+}
+
+int64_t &FreeSpaceMap::ResidueCursor(uint32_t stride, uint32_t residue) {
+  if (stride != cursor_stride_) {
+    cursor_stride_ = stride;
+    first_free_by_residue_.assign(stride, 0);
+  }
+  return first_free_by_residue_[residue];
+}
+
+void FreeSpaceMap::MarkAllocated(int64_t page_id) {
+  if (page_id >= next_page_id_) {
+    // The pages that are skipped become free pages below the high-water mark.
+    Reserve(page_id + 1);
+    num_free_ += page_id - next_page_id_;
+    next_page_id_ = page_id + 1;
+    header_dirty_ = true;
+  } else {
+    --num_free_;
+  }
+  words_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+  dirty_[page_id / BITS_PER_PAGE] = true;
+  if (page_id == first_free_) {
+    ++first_free_;
+  }
+}
+
+void FreeSpaceMap::Reserve(int64_t num_pages) {
+  const auto map_pages = static_cast<size_t>((num_pages + BITS_PER_PAGE - 1) / BITS_PER_PAGE);
+  if (map_pages > dirty_.size()) {
+    words_.resize(map_pages * WORDS_PER_PAGE, 0);
+    dirty_.resize(map_pages, false);
+  }
+}
+
+}  // namespace bustub
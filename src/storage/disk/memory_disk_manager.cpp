@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_disk_manager.cpp
+//
+// Identification: src/storage/disk/memory_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/memory_disk_manager.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace bustub {
+
+void MemoryDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  BUSTUB_ASSERT(page_id >= 0, "Pages on disk have non-negative ids.");
+  num_writes_ += 1;
+  pages_latch_.WLock();
+  auto &page = pages_[page_id];
+  if (page == nullptr) {
+    page = std::make_unique<char[]>(PAGE_SIZE);
+  }
+  memcpy(page.get(), page_data, PAGE_SIZE);
+  pages_latch_.WUnlock();
+}
+
+void MemoryDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  pages_latch_.RLock();
+  auto it = pages_.find(page_id);
+  if (it == pages_.end()) {
+    memset(page_data, 0, PAGE_SIZE);
+  } else {
+    memcpy(page_data, it->second.get(), PAGE_SIZE);
+  }
+  pages_latch_.RUnlock();
+}
+
+void MemoryDiskManager::SyncDataFile() { num_syncs_ += 1; }
+
+void MemoryDiskManager::WriteLog(char *log_data, int size) {
+  // no effect on num_flushes_ if log buffer is empty
+  if (size == 0) {
+    return;
+  }
+  std::scoped_lock guard(log_latch_);
+  num_flushes_ += 1;
+  log_.insert(log_.end(), log_data, log_data + size);
+}
+
+bool MemoryDiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  std::scoped_lock guard(log_latch_);
+  if (offset >= static_cast<int64_t>(log_.size())) {
+    return false;
+  }
+  const auto read_count = static_cast<int>(std::min<int64_t>(size, static_cast<int64_t>(log_.size()) - offset));
+  memcpy(log_data, log_.data() + offset, read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+size_t MemoryDiskManager::GetNumPages() {
+  pages_latch_.RLock();
+  const size_t num_pages = pages_.size();
+  pages_latch_.RUnlock();
+  return num_pages;
+}
+
+}  // namespace bustub
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_extent_map.cpp
+//
+// Identification: src/storage/disk/page_extent_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_extent_map.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+static_assert(PAGE_SIZE % PageExtentMap::SECTOR_SIZE == 0, "A page must take whole sectors.");
+
+namespace {
+
+/** Reads size bytes at offset. @return false on an I/O error or at the end of the file */
+bool ReadFully(int fd, char *data, size_t size, int64_t offset) {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = pread(fd, data + read_count, size - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    read_count += n;
+  }
+  return true;
+}
+
+/** Writes size bytes at offset. @return false on an I/O error */
+bool WriteFully(int fd, const char *data, size_t size, int64_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = pwrite(fd, data + written, size - written, offset + written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+}  // namespace
+
+PageExtentMap::PageExtentMap(const std::string &file_name)
+    : file_name_(file_name), free_runs_(RAW_SECTORS + 1) {
+  std::scoped_lock guard(latch_);
+  Load();
+}
+
+PageExtentMap::~PageExtentMap() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+/**
+ * Unlike the free space map, the extent map cannot be rebuilt from the database file, so a damaged map loses the
+ * database; it is reported, and the map starts out empty
+ */
+void PageExtentMap::Load() {
+  if (!file_name_.empty()) {
+    fd_ = open(file_name_.c_str(), O_RDWR);
+  }
+  if (fd_ < 0) {
+    return;
+  }
+  Header header;
+  if (!ReadFully(fd_, reinterpret_cast<char *>(&header), sizeof(header), 0) || header.magic_ != MAGIC ||
+      header.version_ != VERSION || header.page_size_ != PAGE_SIZE || header.num_pages_ < 0) {
+    LOG_WARN("ignoring damaged page extent map %s", file_name_.c_str());
+    return;
+  }
+  Reserve(header.num_pages_);
+  for (size_t k = 0; k < dirty_.size(); ++k) {
+    if (!ReadFully(fd_, reinterpret_cast<char *>(&extents_[k * ENTRIES_PER_PAGE]), PAGE_SIZE, (k + 1) * PAGE_SIZE)) {
+      LOG_WARN("ignoring damaged page extent map %s", file_name_.c_str());
+      std::fill(extents_.begin(), extents_.end(), PageExtent{});
+      return;
+    }
+  }
+  num_pages_ = header.num_pages_;
+
+  // The free sectors are the gaps between the extents.
+  std::vector<Run> used;
+  for (int64_t page_id = 0; page_id < num_pages_; ++page_id) {
+    const PageExtent &extent = extents_[page_id];
+    if (extent.sectors_ > 0) {
+      used.push_back({extent.offset_, extent.sectors_});
+      stored_bytes_ += extent.sectors_ * SECTOR_SIZE;
+    }
+  }
+  std::sort(used.begin(), used.end(), [](const Run &a, const Run &b) { return a.offset_ < b.offset_; });
+  for (const Run &run : used) {
+    if (run.offset_ > end_) {
+      FreeSectors(end_, (run.offset_ - end_) / SECTOR_SIZE);
+    }
+    end_ = std::max(end_, run.offset_ + run.sectors_ * SECTOR_SIZE);
+  }
+}
+
+PageExtent PageExtentMap::Lookup(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  if (page_id < 0 || page_id >= num_pages_) {
+    return {};
+  }
+  return extents_[page_id];
+}
+
+PageExtent PageExtentMap::Assign(page_id_t page_id, int64_t sectors) {
+  BUSTUB_ASSERT(page_id >= 0, "Pages on disk have non-negative ids.");
+  BUSTUB_ASSERT(sectors >= 0 && sectors <= RAW_SECTORS, "A page takes at most RAW_SECTORS sectors.");
+  std::scoped_lock guard(latch_);
+  if (page_id >= num_pages_) {
+    Reserve(page_id + 1);
+    num_pages_ = page_id + 1;
+    header_dirty_ = true;
+  }
+  PageExtent &extent = extents_[page_id];
+  if (extent.sectors_ == sectors) {
+    return extent;
+  }
+  if (extent.sectors_ > 0) {
+    pending_free_.push_back({extent.offset_, extent.sectors_});
+  }
+  stored_bytes_ += (sectors - extent.sectors_) * SECTOR_SIZE;
+  extent.offset_ = sectors == 0 ? 0 : AllocateSectors(sectors);
+  extent.sectors_ = sectors;
+  dirty_[page_id / ENTRIES_PER_PAGE] = true;
+  return extent;
+}
+
+int64_t PageExtentMap::GetNumPages() {
+  std::scoped_lock guard(latch_);
+  return num_pages_;
+}
+
+int64_t PageExtentMap::GetNumStoredBytes() {
+  std::scoped_lock guard(latch_);
+  return stored_bytes_;
+}
+
+/**
+ * The map pages go first and the header last, so that a crash in between leaves the old number of pages. Sectors that
+ * were given up are only reused once the map that no longer refers to them is durable.
+ */
+bool PageExtentMap::Flush() {
+  std::scoped_lock guard(latch_);
+  const bool any_dirty = std::find(dirty_.begin(), dirty_.end(), true) != dirty_.end();
+  if (!file_name_.empty() && (header_dirty_ || any_dirty)) {
+    if (fd_ < 0) {
+      fd_ = open(file_name_.c_str(), O_RDWR | O_CREAT, 0644);
+      if (fd_ < 0) {
+        LOG_DEBUG("can't create page extent map file");
+        return false;
+      }
+    }
+    for (size_t k = 0; k < dirty_.size(); ++k) {
+      if (!dirty_[k]) {
+        continue;
+      }
+      if (!WriteFully(fd_, reinterpret_cast<const char *>(&extents_[k * ENTRIES_PER_PAGE]), PAGE_SIZE,
+                      (k + 1) * PAGE_SIZE)) {
+        LOG_DEBUG("I/O error while writing page extent map");
+        return false;
+      }
+      dirty_[k] = false;
+    }
+    char header_page[PAGE_SIZE] = {0};
+    const Header header{MAGIC, VERSION, num_pages_, PAGE_SIZE};
+    memcpy(header_page, &header, sizeof(header));
+    if (!WriteFully(fd_, header_page, PAGE_SIZE, 0) || fdatasync(fd_) != 0) {
+      LOG_DEBUG("I/O error while writing page extent map");
+      return false;
+    }
+    header_dirty_ = false;
+  }
+  for (const Run &run : pending_free_) {
+    FreeSectors(run.offset_, run.sectors_);
+  }
+  pending_free_.clear();
+  return true;
+}
+
+/** Takes a run of exactly the right length if there is one, else splits the shortest longer one. */
+int64_t PageExtentMap::AllocateSectors(int64_t sectors) {
+  for (int64_t n = sectors; n <= RAW_SECTORS; ++n) {
+    if (free_runs_[n].empty()) {
+      continue;
+    }
+    const int64_t offset = free_runs_[n].back();
+    free_runs_[n].pop_back();
+    if (n > sectors) {
+      free_runs_[n - sectors].push_back(offset + sectors * SECTOR_SIZE);
+    }
+    return offset;
+  }
+  const int64_t offset = end_;
+  end_ += sectors * SECTOR_SIZE;
+  return offset;
+}
+
+void PageExtentMap::FreeSectors(int64_t offset, int64_t sectors) {
+  while (sectors > 0) {
+    const int64_t n = std::min(sectors, RAW_SECTORS);
+    free_runs_[n].push_back(offset);
+    offset += n * SECTOR_SIZE;
+    sectors -= n;
+  }
+}
+
+void PageExtentMap::Reserve(int64_t num_pages) {
+  const auto map_pages = static_cast<size_t>((num_pages + ENTRIES_PER_PAGE - 1) / ENTRIES_PER_PAGE);
+  if (map_pages > dirty_.size()) {
+    extents_.resize(map_pages * ENTRIES_PER_PAGE);
+    dirty_.resize(map_pages, false);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simulated_latency_disk_manager.cpp
+//
+// Identification: src/storage/disk/simulated_latency_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/simulated_latency_disk_manager.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+SimulatedLatencyDiskManager::SimulatedLatencyDiskManager(DiskManager *disk_manager,
+                                                         const SimulatedLatencyOptions &options)
+    : disk_manager_(disk_manager),
+      options_(options),
+      transfer_time_(options.bandwidth == 0 ? 0 : uint64_t{PAGE_SIZE} * 1000000000 / options.bandwidth),
+      device_free_(std::chrono::steady_clock::now()) {}
+
+void SimulatedLatencyDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  Delay(options_.write_latency);
+  disk_manager_->WritePage(page_id, page_data);
+}
+
+void SimulatedLatencyDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  Delay(options_.read_latency);
+  disk_manager_->ReadPage(page_id, page_data);
+}
+
+void SimulatedLatencyDiskManager::SyncDataFile() {
+  if (options_.sync_latency.count() > 0) {
+    std::this_thread::sleep_for(options_.sync_latency);
+  }
+  disk_manager_->SyncDataFile();
+}
+
+void SimulatedLatencyDiskManager::Delay(std::chrono::microseconds latency) {
+  auto done = std::chrono::steady_clock::now();
+  if (transfer_time_.count() > 0) {
+    // Take the next turn of the device; an idle device does not bank bandwidth for later.
+    std::scoped_lock guard(device_latch_);
+    device_free_ = std::max(device_free_, done) + transfer_time_;
+    done = device_free_;
+  }
+  done += latency;
+  if (done > std::chrono::steady_clock::now()) {
+    std::this_thread::sleep_until(done);
+  }
+}
+
+}  // namespace bustub
@@ -20,13 +20,14 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool swizzle_children)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      swizzle_children_(swizzle_children) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -48,15 +49,13 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     latch_.RUnlock();
     return false;
   }
-  Page *page = FindLeafPage(key);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ReadPageGuard guard = FindLeafPage(key);
+  const LeafPage *leaf = guard.As<LeafPage>();
   ValueType value{};
   bool exist = leaf->Lookup(key, &value, comparator_);
   if (exist) {
     result->emplace_back(value);
   }
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
   return exist;
 }
 
@@ -89,15 +88,14 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
-  Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
-  if (page == nullptr) {
+  BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(&root_page_id_);
+  if (!guard.IsValid()) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page.");
   }
   UpdateRootPageId(1);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  LeafPage *leaf = guard.AsMut<LeafPage>();
   leaf->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
   leaf->Insert(key, value, comparator_);
-  buffer_pool_manager_->UnpinPage(root_page_id_, true);
 }
 
 /*
@@ -140,8 +138,9 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  int page_id = INVALID_PAGE_ID;
-  Page *new_page = buffer_pool_manager_->NewPage(&page_id);
+  page_id_t page_id = INVALID_PAGE_ID;
+  // The new sibling follows the node in key order, so place it after the node on disk as well.
+  Page *new_page = buffer_pool_manager_->NewPageNear(&page_id, node->GetPageId());
   if (new_page == nullptr) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page.");
   }
@@ -164,24 +163,22 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
   if (old_node->IsRootPage()) {
-    Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
-    if (page == nullptr) {
+    BasicPageGuard root_guard = buffer_pool_manager_->NewPageGuarded(&root_page_id_);
+    if (!root_guard.IsValid()) {
       throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a new page.");
     }
     UpdateRootPageId(0);
-    InternalPage *root = reinterpret_cast<InternalPage *>(page->GetData());
+    InternalPage *root = root_guard.AsMut<InternalPage>();
     root->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
     root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
     old_node->SetParentPageId(root_page_id_);
     new_node->SetParentPageId(root_page_id_);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
     return;
   }
-  Page *parent_page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
-  assert(parent_page != nullptr);
-  // assert(parent_page->GetPinCount() == 2);
-  InternalPage *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  BasicPageGuard parent_guard = buffer_pool_manager_->FetchPageBasic(old_node->GetParentPageId());
+  assert(parent_guard.IsValid());
+  InternalPage *parent = parent_guard.AsMut<InternalPage>();
   if (parent->GetSize() < internal_max_size_) {
     parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
@@ -199,7 +196,6 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
     InsertIntoParent(parent, middle_key, new_inner);
   }
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 
 /*****************************************************************************
@@ -260,9 +256,10 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   if (node->GetSize() >= node->GetMinSize() && ((!node->IsLeafPage() && node->GetSize() > 1) || node->IsLeafPage())) {
     return false;
   }
-  Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
-  assert(parent_page != nullptr);
-  InternalPage *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  // The parent stays pinned until the end of the function, since Coalesce modifies it.
+  BasicPageGuard parent_guard = buffer_pool_manager_->FetchPageBasic(node->GetParentPageId());
+  assert(parent_guard.IsValid());
+  InternalPage *parent = parent_guard.AsMut<InternalPage>();
   assert(parent->GetSize() > 1);
   int index = parent->ValueIndex(node->GetPageId());
   assert(index >= 0);
@@ -274,14 +271,12 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   silbing_page->WLatch();
   bool need_redistribute = node->IsLeafPage() ? sibling->GetSize() + node->GetSize() >= node->GetMaxSize()
                                               : sibling->GetSize() + node->GetSize() > node->GetMaxSize();
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
   if (need_redistribute) {
     Redistribute(sibling, node, index);
     silbing_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(silbing_page->GetPageId(), true);
     return false;
   }
-  assert(parent_page->GetPinCount() > 0);
   Coalesce(&sibling, &node, &parent, index, transaction);
   silbing_page->WUnlatch();
   // std::cout<<node->GetPageId()<<" "<<sibling->GetPageId()<<std::endl;
@@ -341,9 +336,9 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
-  InternalPage *parent =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
-  assert(parent != nullptr);
+  BasicPageGuard parent_guard = buffer_pool_manager_->FetchPageBasic(node->GetParentPageId());
+  assert(parent_guard.IsValid());
+  InternalPage *parent = parent_guard.AsMut<InternalPage>();
   assert(parent->GetSize() > 1);
   // std::cout<<neighbor_node->GetPageId()<<" "<<node->GetPageId()<<" "<<index<<" "<<std::endl;
   if (index == 0) {  // node->neighbor_node
@@ -356,7 +351,6 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
     neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
     parent->SetKeyAt(index, new_middle_key);
   }
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
 }
 /*
  * Update root page if necessary
@@ -373,12 +367,10 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
   if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {  // case 1
     InternalPage *inner = static_cast<InternalPage *>(old_root_node);
     root_page_id_ = inner->RemoveAndReturnOnlyChild();
-    BPlusTreePage *new_root =
-        reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-    assert(new_root != nullptr);
-    new_root->SetParentPageId(INVALID_PAGE_ID);
+    BasicPageGuard new_root = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+    assert(new_root.IsValid());
+    new_root.AsMut<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
     UpdateRootPageId(0);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
     return true;
   }
   if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {  // case 2
@@ -400,10 +392,7 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
   KeyType key{};
   latch_.RLock();
-  Page *page = FindLeafPage(key, true);
-  page_id_t page_id = page->GetPageId();
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  page_id_t page_id = FindLeafPage(key, true).PageId();
   return {page_id, 0, buffer_pool_manager_};
 }
 
@@ -415,12 +404,9 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
   latch_.RLock();
-  Page *page = FindLeafPage(key);
-  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  page_id_t page_id = leaf->GetPageId();
-  int index = leaf->KeyIndex(key, comparator_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  ReadPageGuard guard = FindLeafPage(key);
+  page_id_t page_id = guard.PageId();
+  int index = guard.As<LeafPage>()->KeyIndex(key, comparator_);
   return {page_id, index, buffer_pool_manager_};
 }
 
@@ -440,38 +426,33 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return {INVALID_PAGE_ID, 0, buffer_po
  * the left most leaf page
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
+ReadPageGuard BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
   page_id_t page_id = root_page_id_;
   latch_.RUnlock();
-  Page *page = nullptr;
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
 
   while (true) {
-    page = buffer_pool_manager_->FetchPage(page_id);
-    assert(page != nullptr);
-    page->RLatch();
-    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    assert(guard.IsValid());
+    const BPlusTreePage *node = guard.As<BPlusTreePage>();
     if (node->IsLeafPage()) {
       break;
     }
-    InternalPage *inner = static_cast<InternalPage *>(node);
-    if (leftMost) {
-      page_id = inner->ValueAt(0);
-    } else {
-      page_id = inner->Lookup(key, comparator_);
+    const InternalPage *inner = static_cast<const InternalPage *>(node);
+    // The parent stays latched until the child is, so its child references cannot change in between.
+    Page *child = FetchChildPage(guard.AsPage<Page>(), inner, leftMost ? 0 : inner->LookupIndex(key, comparator_));
+    if (child != nullptr) {
+      child->RLatch();
     }
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+    guard = ReadPageGuard(buffer_pool_manager_, child);
   }
-  return page;
+  return guard;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, BPlusTreeOpType op_type, Transaction *transaction) {
   assert(transaction != nullptr);
-  page_id_t page_id = root_page_id_;
-  Page *page = nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
   while (true) {
-    page = buffer_pool_manager_->FetchPage(page_id);
     assert(page != nullptr);
     BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     page->WLatch();
@@ -489,12 +470,20 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, BPlusTreeOpType op_type,
       UnlockAncestorPages(false, transaction);
     }
     transaction->AddIntoPageSet(page);
-    page_id = inner->Lookup(key, comparator_);
+    page = FetchChildPage(page, inner, inner->LookupIndex(key, comparator_));
   }
   // std::cout<<"break"<<std::endl;
   return page;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchChildPage(Page *parent, const InternalPage *inner, int index) {
+  if (swizzle_children_) {
+    return buffer_pool_manager_->FetchChildPage(parent, index, inner->ValueAt(index));
+  }
+  return buffer_pool_manager_->FetchPage(inner->ValueAt(index));
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UnlockAncestorPages(bool is_dirty, Transaction *transaction) {
   std::shared_ptr<std::deque<Page *>> locked_pages = transaction->GetPageSet();
@@ -520,7 +509,8 @@ void BPLUSTREE_TYPE::UnlockAncestorPages(bool is_dirty, Transaction *transaction
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(HEADER_PAGE_ID);
+  auto header_page = guard.AsPageMut<HeaderPage>();
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -528,7 +518,6 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
@@ -20,18 +20,18 @@ namespace bustub {
  * Record related
  */
 bool HeaderPage::InsertRecord(const std::string &name, const page_id_t root_id) {
-  assert(name.length() < 32);
+  assert(name.length() < NAME_SIZE);
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
+  int offset = OFFSET_RECORDS + record_num * RECORD_SIZE;
   // check for duplicate name
   if (FindRecord(name) != -1) {
     return false;
   }
   // copy record content
   memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
-  memcpy((GetData() + offset + 32), &root_id, 4);
+  memcpy((GetData() + offset + NAME_SIZE), &root_id, sizeof(page_id_t));
 
   SetRecordCount(record_num + 1);
   return true;
@@ -46,37 +46,37 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36, (record_num - index - 1) * 36);
+  int offset = index * RECORD_SIZE + OFFSET_RECORDS;
+  memmove(GetData() + offset, GetData() + offset + RECORD_SIZE, (record_num - index - 1) * RECORD_SIZE);
 
   SetRecordCount(record_num - 1);
   return true;
 }
 
 bool HeaderPage::UpdateRecord(const std::string &name, const page_id_t root_id) {
-  assert(name.length() < 32);
+  assert(name.length() < NAME_SIZE);
 
   int index = FindRecord(name);
   // record does not exsit
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
+  int offset = index * RECORD_SIZE + OFFSET_RECORDS;
   // update record content, only root_id
-  memcpy((GetData() + offset + 32), &root_id, 4);
+  memcpy((GetData() + offset + NAME_SIZE), &root_id, sizeof(page_id_t));
 
   return true;
 }
 
 bool HeaderPage::GetRootId(const std::string &name, page_id_t *root_id) {
-  assert(name.length() < 32);
+  assert(name.length() < NAME_SIZE);
 
   int index = FindRecord(name);
   // record does not exsit
   if (index == -1) {
     return false;
   }
-  int offset = (index + 1) * 36;
+  int offset = OFFSET_RECORDS + index * RECORD_SIZE + NAME_SIZE;
   *root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -94,7 +94,7 @@ int HeaderPage::FindRecord(const std::string &name) {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + (OFFSET_RECORDS + i * RECORD_SIZE));
     if (strcmp(raw_name, name.c_str()) == 0) {
       return i;
     }
@@ -19,7 +19,7 @@ namespace bustub {
 void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
                      Transaction *txn) {
   // Set the page ID.
-  memcpy(GetData(), &page_id, sizeof(page_id));
+  memcpy(GetData() + OFFSET_PAGE_ID, &page_id, sizeof(page_id));
   // Log that we are creating a new page.
   if (enable_logging) {
     LogRecord log_record =
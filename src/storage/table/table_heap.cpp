@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -28,63 +32,49 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
-  BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
-  first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  auto first_page = buffer_pool_manager_->NewPageGuarded(&first_page_id_).UpgradeWrite();
+  BUSTUB_ASSERT(first_page.IsValid(), "Couldn't create a page for the table heap.");
+  first_page.AsPageMut<TablePage>()->Init(first_page_id_, PAGE_USABLE_SIZE, INVALID_LSN, log_manager_, txn);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 32 > PAGE_USABLE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  auto cur_page = buffer_pool_manager_->FetchPageWrite(first_page_id_);
+  if (!cur_page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
   // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
+  // Moving a guard into cur_page unlatches and unpins the page it held before.
+  while (!cur_page.AsPage<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    auto next_page_id = cur_page.AsPage<TablePage>()->GetNextPageId();
+    // If the next page is a valid page, repeat the process with the next page.
     if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      cur_page = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      BUSTUB_ASSERT(cur_page.IsValid(), "Couldn't fetch the next page of the table heap.");
+      continue;
+    }
+    // Otherwise we have run out of valid pages. We need to create a new page, next to the last one on disk.
+    auto new_page = buffer_pool_manager_->NewPageGuarded(&next_page_id, cur_page.PageId()).UpgradeWrite();
+    // If we could not create a new page, then life sucks and we abort the transaction.
+    if (!new_page.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
+    // Otherwise we were able to create a new page. We initialize it now.
+    auto cur_table_page = cur_page.AsPageMut<TablePage>();
+    cur_table_page->SetNextPageId(next_page_id);
+    new_page.AsPageMut<TablePage>()->Init(next_page_id, PAGE_USABLE_SIZE, cur_table_page->GetTablePageId(),
+                                          log_manager_, txn);
+    cur_page = std::move(new_page);
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  cur_page.MarkDirty();
+  cur_page.Drop();
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
@@ -92,18 +82,17 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
-  // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
-    txn->SetState(TransactionState::ABORTED);
-    return false;
+  {
+    // Find the page which contains the tuple.
+    auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    // If the page could not be found, then abort the transaction.
+    if (!page.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    // Otherwise, mark the tuple as deleted.
+    page.AsPageMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
   }
-  // Otherwise, mark the tuple as deleted.
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
@@ -111,18 +100,19 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  bool is_updated = page.AsPage<TablePage>()->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    page.MarkDirty();
+  }
+  page.Drop();
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
@@ -132,41 +122,75 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page.IsValid(), "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  page.AsPageMut<TablePage>()->ApplyDelete(rid, txn, log_manager_);
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  BUSTUB_ASSERT(page.IsValid(), "Couldn't find a page containing that RID.");
   // Rollback the delete.
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  page.AsPageMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
-  if (page == nullptr) {
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return page.AsPage<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
+}
+
+bool TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn) {
+  tuples->assign(rids.size(), Tuple{});
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(rids.size());
+  for (const auto &rid : rids) {
+    page_ids.push_back(rid.GetPageId());
+  }
+  // page_ids comes back sorted and deduplicated, with pages[i] holding page_ids[i].
+  std::vector<Page *> pages = buffer_pool_manager_->FetchPages(&page_ids);
+  std::vector<BasicPageGuard> guards;
+  guards.reserve(pages.size());
+  for (auto *page : pages) {
+    guards.emplace_back(buffer_pool_manager_, page);
+  }
+
+  // Visit the rids in page order, so that every page is latched once.
+  std::vector<size_t> order(rids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return rids[a].GetPageId() < rids[b].GetPageId(); });
+  bool all_read = true;
+  size_t page_index = 0;
+  for (size_t i = 0; i < order.size();) {
+    const page_id_t page_id = rids[order[i]].GetPageId();
+    while (page_ids[page_index] != page_id) {
+      ++page_index;
+    }
+    // A page that the batch found no frame for, e.g. because the batch spans more pages than the pool holds, is
+    // fetched on its own, now that the pages before it are unpinned. Only if that fails, abort the transaction.
+    ReadPageGuard page = guards[page_index].IsValid() ? guards[page_index].UpgradeRead()
+                                                      : buffer_pool_manager_->FetchPageRead(page_id);
+    if (!page.IsValid()) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    for (; i < order.size() && rids[order[i]].GetPageId() == page_id; ++i) {
+      if (!page.AsPage<TablePage>()->GetTuple(rids[order[i]], &(*tuples)[order[i]], txn, lock_manager_)) {
+        all_read = false;
+      }
+    }
+  }
+  return all_read;
 }
 
 TableIterator TableHeap::Begin(Transaction *txn) {
@@ -175,16 +199,12 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
+    auto page = buffer_pool_manager_->FetchPageRead(page_id);
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
-    if (found_tuple) {
+    if (page.AsPage<TablePage>()->GetFirstTupleRid(&rid)) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = page.AsPage<TablePage>()->GetNextPageId();
   }
   return TableIterator(this, rid, txn);
 }
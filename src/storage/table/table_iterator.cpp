@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 #include "storage/table/table_heap.h"
 
@@ -35,20 +37,16 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  auto cur_page = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId());
+  assert(cur_page.IsValid());  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+  if (!cur_page.AsPage<TablePage>()->GetNextTupleRid(tuple_->rid_,
+                                                     &next_tuple_rid)) {  // end of this page
+    while (cur_page.AsPage<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      // The next page is latched before the assignment releases the current one.
+      cur_page = buffer_pool_manager->FetchPageRead(cur_page.AsPage<TablePage>()->GetNextPageId());
+      if (cur_page.AsPage<TablePage>()->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
     }
@@ -58,12 +56,49 @@ TableIterator &TableIterator::operator++() {
   if (*this != table_heap_->End()) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
+  page_id_t cur_page_id = cur_page.PageId();
+  page_id_t next_page_id = cur_page.AsPage<TablePage>()->GetNextPageId();
   // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  cur_page.Drop();
+  if (cur_page_id != readahead_page_id_) {
+    ReadAhead(cur_page_id, next_page_id);
+  }
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t page_id, page_id_t next_page_id) {
+  readahead_page_id_ = page_id;
+  // Drop the part of the window that the scan has reached.
+  auto it = std::find(readahead_.begin(), readahead_.end(), page_id);
+  if (it == readahead_.end()) {
+    readahead_.clear();
+  } else {
+    readahead_.erase(readahead_.begin(), it + 1);
+  }
+
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  std::vector<page_id_t> page_ids;
+  page_id_t tail_page_id = readahead_.empty() ? page_id : readahead_.back();
+  while (readahead_.size() < static_cast<size_t>(SCAN_READAHEAD_PAGES)) {
+    if (tail_page_id != page_id) {
+      // The successor of the window's last page is only known once that page has been read. If it is still in
+      // flight, try again when the iterator reaches the next page.
+      BasicPageGuard tail_guard(buffer_pool_manager, buffer_pool_manager->FetchPageIfResident(tail_page_id));
+      if (!tail_guard.IsValid()) {
+        break;
+      }
+      next_page_id = tail_guard.UpgradeRead().AsPage<TablePage>()->GetNextPageId();
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    readahead_.push_back(next_page_id);
+    page_ids.push_back(next_page_id);
+    tail_page_id = next_page_id;
+  }
+  buffer_pool_manager->PrefetchPages(page_ids);
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_benchmark.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_latency_disk_manager.h"
+
+// Measures FetchPage/UnpinPage throughput of a single BufferPoolManagerInstance against a ParallelBufferPoolManager
+// with the same total number of frames, for an increasing number of threads. Most accesses go to a hot set that fits
+// in the pool; the rest miss and go to disk.
+
+namespace bustub {
+
+static double RunWorkload(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                          uint64_t ops_per_thread, uint64_t hot_pages) {
+  return RunThreads(num_threads, [&](size_t tid) {
+    std::mt19937_64 rng(tid);
+    std::uniform_int_distribution<size_t> hot(0, hot_pages - 1);
+    std::uniform_int_distribution<size_t> cold(0, page_ids.size() - 1);
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      page_id_t page_id = page_ids[i % 10 == 0 ? cold(rng) : hot(rng)];
+      Page *page = bpm->FetchPage(page_id);
+      if (page == nullptr) {
+        continue;
+      }
+      page->RLatch();
+      volatile char c = page->GetData()[tid % PAGE_SIZE];
+      (void)c;
+      page->RUnlatch();
+      bpm->UnpinPage(page_id, false);
+    }
+  });
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  using bustub::BufferPoolManager;
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t max_threads = args.GetInt("threads", std::thread::hardware_concurrency());
+  const uint64_t num_instances = args.GetInt("instances", 8);
+  const uint64_t pool_size = args.GetInt("pool_size", 1024);
+  const uint64_t num_pages = args.GetInt("pages", 4096);
+  const uint64_t ops_per_thread = args.GetInt("ops", 200000);
+  const std::string db_name = args.GetString("db", "bpm_bench.db");
+  const std::string disk = args.GetString("disk", "file");
+  bustub::SimulatedLatencyOptions latency;
+  latency.read_latency = std::chrono::microseconds(args.GetInt("read_latency_us", 0));
+  latency.write_latency = std::chrono::microseconds(args.GetInt("write_latency_us", 0));
+  latency.bandwidth = args.GetInt("bandwidth_mib", 0) << 20;
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  // --disk=memory measures the buffer pool without a device, --disk=direct the file without the page cache behind the
+  // pool, and --disk=compressed a file of compressed pages; the latency flags simulate a device on top of any disk.
+  std::unique_ptr<bustub::DiskManager> base_disk_manager;
+  if (disk == "memory") {
+    base_disk_manager = std::make_unique<bustub::MemoryDiskManager>();
+  } else {
+    bustub::DiskManagerOptions disk_options;
+    disk_options.direct_io = disk == "direct";
+    disk_options.compression = disk == "compressed";
+    base_disk_manager = std::make_unique<bustub::DiskManager>(db_name, disk_options);
+  }
+  std::unique_ptr<bustub::DiskManager> disk_manager;
+  if (latency.read_latency.count() > 0 || latency.write_latency.count() > 0 || latency.bandwidth > 0) {
+    disk_manager = std::make_unique<bustub::SimulatedLatencyDiskManager>(base_disk_manager.get(), latency);
+  } else {
+    disk_manager = std::move(base_disk_manager);
+  }
+  std::vector<bustub::page_id_t> page_ids;
+  {
+    // Lay out the pages on disk once; both pools read the same file.
+    bustub::ParallelBufferPoolManager loader(num_instances, pool_size / num_instances, disk_manager.get());
+    for (uint64_t i = 0; i < num_pages; ++i) {
+      bustub::page_id_t page_id;
+      auto *page = loader.NewPage(&page_id);
+      snprintf(page->GetData(), bustub::PAGE_SIZE, "page %s", std::to_string(page_id).c_str());
+      loader.UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+    loader.FlushAllPages();
+  }
+
+  printf("%8s %14s %14s %8s\n", "threads", "instance op/s", "parallel op/s", "speedup");
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    std::unique_ptr<BufferPoolManager> single =
+        std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    std::unique_ptr<BufferPoolManager> parallel = std::make_unique<bustub::ParallelBufferPoolManager>(
+        num_instances, pool_size / num_instances, disk_manager.get());
+    const uint64_t hot_pages = pool_size / 2;
+    double single_secs = bustub::RunWorkload(single.get(), page_ids, threads, ops_per_thread, hot_pages);
+    double parallel_secs = bustub::RunWorkload(parallel.get(), page_ids, threads, ops_per_thread, hot_pages);
+    double total_ops = static_cast<double>(threads * ops_per_thread);
+    printf("%8lu %14.0f %14.0f %7.2fx\n", threads, total_ops / single_secs, total_ops / parallel_secs,
+           single_secs / parallel_secs);
+    if (threads * 2 > max_threads && threads != max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".pmap").c_str());
+  return 0;
+}
@@ -10,11 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_latency_disk_manager.h"
 
 namespace bustub {
 
@@ -29,7 +36,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::uniform_int_distribution<char> uniform_dist(0);
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -80,6 +87,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
 
   delete bpm;
   delete disk_manager;
@@ -91,7 +99,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const size_t buffer_pool_size = 10;
 
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(&page_id_temp);
@@ -136,9 +144,940 @@ TEST(BufferPoolManagerTest, SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fsm");
 
   delete bpm;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 16;
+  const int num_threads = 4;
+  const int rounds = 200;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: threads fetch overlapping pages through a pool that is much smaller than the working set, so that
+  // dirty write-backs and reads are in flight while other threads hit or wait on the same frames. Every fetch must
+  // observe the content of the page it asked for.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < rounds; ++i) {
+        page_id_t page_id = dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // Every frame is pinned by the other threads.
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: a deleted page goes back to the free list and is not handed out twice.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->DeletePage(0));
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReplacementPolicyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_hot = 5;
+  const int num_scan = 64;
+
+  auto *disk_manager = new DiskManager(db_name);
+  for (auto policy : {BufferPoolManager::ReplacementPolicy::LRU, BufferPoolManager::ReplacementPolicy::LRU_K,
+                      BufferPoolManager::ReplacementPolicy::CLOCK, BufferPoolManager::ReplacementPolicy::CLOCK_PRO}) {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, policy);
+
+    // Scenario: a small working set is created and then accessed a couple of times.
+    std::vector<page_id_t> hot_page_ids;
+    for (int i = 0; i < num_hot; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      hot_page_ids.push_back(page_id);
+    }
+    for (int round = 0; round < 2; ++round) {
+      for (auto page_id : hot_page_ids) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    }
+
+    // Scenario: a scan much larger than the pool touches every page once. Every policy must keep serving pages.
+    for (int i = 0; i < num_scan; ++i) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "scan-%s", std::to_string(page_id).c_str());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: LRU lets the scan flush out the working set, LRU-K and CLOCK-Pro keep it resident.
+    std::vector<page_id_t> resident;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      resident.push_back(bpm->GetPages()[i].GetPageId());
+    }
+    for (auto page_id : hot_page_ids) {
+      bool is_resident = std::find(resident.begin(), resident.end(), page_id) != resident.end();
+      if (policy == BufferPoolManager::ReplacementPolicy::LRU) {
+        EXPECT_FALSE(is_resident);
+      } else if (policy != BufferPoolManager::ReplacementPolicy::CLOCK) {
+        EXPECT_TRUE(is_resident);
+      }
+    }
+
+    // Scenario: evicted pages can still be read back.
+    Page *page = bpm->FetchPage(hot_page_ids.size());
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("scan-" + std::to_string(hot_page_ids.size()), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page->GetPageId(), false));
+
+    delete bpm;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: a fresh pool has nothing resident, and FetchPageIfResident never reads from disk.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(nullptr, bpm->FetchPageIfResident(page_ids[0]));
+
+  // Scenario: prefetched pages show up in the pool without anyone fetching them, unpinned.
+  bpm->PrefetchPages(page_ids);
+  for (auto page_id : page_ids) {
+    Page *page = nullptr;
+    for (int attempt = 0; attempt < 1000 && page == nullptr; ++attempt) {
+      page = bpm->FetchPageIfResident(page_id);
+      if (page == nullptr) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching resident pages is a no-op, and fetching them is a hit with the same content.
+  bpm->PrefetchPages(page_ids);
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 6;
+  const int num_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the batch is sorted and deduplicated, and every distinct page is pinned once, hits and misses alike.
+  // Page 1 has been evicted to make room for the later pages, 3, 6 and 7 are hits.
+  std::vector<page_id_t> batch{7, 3, 1, 3, 6, 1};
+  std::vector<Page *> pages = bpm->FetchPages(&batch);
+  ASSERT_EQ((std::vector<page_id_t>{1, 3, 6, 7}), batch);
+  ASSERT_EQ(batch.size(), pages.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(batch[i], pages[i]->GetPageId());
+    EXPECT_EQ(1, pages[i]->GetPinCount());
+    EXPECT_EQ("page-" + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+  }
+
+  // Scenario: pages for which no frame is left come back as nullptr; the batch itself holds four of the six frames.
+  std::vector<page_id_t> overflow{0, 2, 4, 5};
+  std::vector<Page *> overflow_pages = bpm->FetchPages(&overflow);
+  EXPECT_NE(nullptr, overflow_pages[0]);
+  EXPECT_NE(nullptr, overflow_pages[1]);
+  EXPECT_EQ(nullptr, overflow_pages[2]);
+  EXPECT_EQ(nullptr, overflow_pages[3]);
+  for (size_t i = 0; i < overflow.size(); ++i) {
+    if (overflow_pages[i] != nullptr) {
+      EXPECT_TRUE(bpm->UnpinPage(overflow[i], false));
+    }
+  }
+  for (auto page_id : batch) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+  std::vector<page_id_t> page_ids;
+  std::vector<Page *> pages;
+  for (int i = 0; i < 4; ++i) {
+    page_id_t page_id;
+    pages.push_back(bpm->NewPage(&page_id));
+    ASSERT_NE(nullptr, pages.back());
+    snprintf(pages.back()->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    page_ids.push_back(page_id);
+  }
+  page_id_t temp_page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&temp_page_id));
+
+  // Scenario: growing adds free frames, and the pinned pages stay where they are.
+  ASSERT_TRUE(bpm->Resize(8));
+  EXPECT_EQ(8, bpm->GetPoolSize());
+  for (int i = 0; i < 4; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ("page-" + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+
+  // Scenario: shrinking fails while a frame that would go away is pinned, and leaves the pool as it was.
+  EXPECT_FALSE(bpm->Resize(2));
+  EXPECT_EQ(8, bpm->GetPoolSize());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+
+  // Scenario: once every page is unpinned, shrinking evicts the dirty pages with a write, and every page can be read
+  // back through the smaller pool.
+  ASSERT_TRUE(bpm->Resize(2));
+  EXPECT_EQ(2, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_FALSE(bpm->Resize(0));
+
+  // Scenario: the pool keeps serving fetches while another thread grows and shrinks it.
+  std::atomic<bool> done{false};
+  std::thread resizer([&] {
+    for (size_t round = 0; !done; ++round) {
+      bpm->Resize(round % 2 == 0 ? 6 : 3);
+    }
+  });
+  for (int round = 0; round < 200; ++round) {
+    for (auto page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  done = true;
+  resizer.join();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, log_manager);
+
+  // Fill the pool with dirty pages. The first half have log records that are not on disk yet.
+  enable_logging = true;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData() + 64, PAGE_SIZE - 64, "page-%s", std::to_string(page_id).c_str());
+    page->SetLSN(i < buffer_pool_size / 2 ? 100 : INVALID_LSN);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  auto wait_for_writes = [disk_manager](int num_writes) {
+    for (int attempt = 0; attempt < 1000 && disk_manager->GetNumWrites() < num_writes; ++attempt) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return disk_manager->GetNumWrites();
+  };
+
+  // Scenario: the writer only writes the pages whose log records are persistent.
+  BackgroundWriterOptions options;
+  options.interval = std::chrono::milliseconds(1);
+  options.batch_size = 2;
+  options.target_clean_ratio = 1.0;
+  bpm->StartBackgroundWriter(options);
+  EXPECT_EQ(static_cast<int>(buffer_pool_size / 2), wait_for_writes(buffer_pool_size / 2));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(static_cast<int>(buffer_pool_size / 2), disk_manager->GetNumWrites());
+
+  // Scenario: once the log is flushed far enough, the remaining pages are written as well.
+  log_manager->SetPersistentLSN(100);
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), wait_for_writes(buffer_pool_size));
+  bpm->StopBackgroundWriter();
+  enable_logging = false;
+
+  // Scenario: every page is clean now, so evicting them costs no writes, and the content survives.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData() + 64));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: with the default clean ratio, a pool with enough clean frames is left alone.
+  bpm->StartBackgroundWriter(BackgroundWriterOptions());
+  Page *page = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], true));
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+
+  // Scenario: whatever huge page mode is asked for, the pool comes up, falling back if the system has no huge pages,
+  // and keeps the data of its frames in one huge page aligned range, apart from the cache-line aligned Pages.
+  for (auto mode : {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT}) {
+    FrameArenaOptions options;
+    options.huge_pages = mode;
+    options.numa_node = 0;
+    options.max_pool_size = 4 * buffer_pool_size;
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr,
+                                              BufferPoolManager::ReplacementPolicy::LRU, options);
+    std::vector<Page *> pages;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t page_id;
+      pages.push_back(bpm->NewPage(&page_id));
+      ASSERT_NE(nullptr, pages.back());
+      snprintf(pages.back()->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    std::sort(pages.begin(), pages.end());
+    const auto *data = bpm->GetPages()[0].GetData();
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % FrameArena::HUGE_PAGE_SIZE);
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[i]) % 64);
+      EXPECT_EQ(data + i * PAGE_SIZE, pages[i]->GetData());
+    }
+
+    // Scenario: the pool grows up to max_pool_size, with the data of the new frames committed as they come, and
+    // shrinks back, which returns it.
+    EXPECT_FALSE(bpm->Resize(4 * buffer_pool_size + 1));
+    ASSERT_TRUE(bpm->Resize(4 * buffer_pool_size));
+    for (size_t i = buffer_pool_size; i < 4 * buffer_pool_size; ++i) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+    bpm->FlushAllPages();
+    delete bpm;
+  }
+
+  // Scenario: the pages written through one arena are read back through another.
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LockFreeHitTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 24;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: hits on the lock-free path race with misses that evict their frames, with deletions, and with resizing.
+  // Every fetched page must hold its own content, and every pin must be released exactly once.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      // Half of the accesses go to two hot pages, which are mostly hits.
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (int i = 0; i < 5000; ++i) {
+        const page_id_t page_id = i % 2 == 0 ? static_cast<page_id_t>(i / 2 % 2) : dist(rng);
+        Page *page = i % 4 == 1 ? bpm->FetchPageIfResident(page_id) : bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        page->RLatch();
+        EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 3 == 0));
+      }
+    });
+  }
+  std::thread other([&] {
+    for (int round = 0; !done; ++round) {
+      bpm->Resize(round % 2 == 0 ? buffer_pool_size / 2 : buffer_pool_size);
+      // Deleting a resident page only succeeds while nobody holds it, and an unwritten page reads back as zeroes, so
+      // only delete a page that is not in use by the other threads.
+      page_id_t page_id;
+      Page *page = bpm->NewPage(&page_id);
+      if (page != nullptr) {
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        EXPECT_TRUE(bpm->DeletePage(page_id));
+      }
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  other.join();
+
+  // Every pin has been released, so all the pages can be evicted in turn.
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, SnapshotTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: the resident pages are listed in LRU order, with the pinned page last.
+  const std::vector<page_id_t> touch_order = {5, 2, 7, 0, 3, 6, 1, 4};
+  for (auto page_id : touch_order) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ((std::vector<page_id_t>{5, 2, 7, 0, 3, 6, 4, 1}), bpm->GetResidentPages());
+  EXPECT_TRUE(bpm->SaveSnapshot());
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  delete bpm;
+
+  // Scenario: a smaller pool warms up with the hottest pages of the snapshot, in their old order.
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  EXPECT_TRUE(bpm->LoadSnapshot());
+  const std::vector<page_id_t> expected = {3, 6, 4, 1};
+  for (int attempt = 0; attempt < 1000 && bpm->GetResidentPages() != expected; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(expected, bpm->GetResidentPages());
+  for (auto page_id : expected) {
+    Page *page = bpm->FetchPageIfResident(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  delete bpm;
+
+  // Scenario: without a snapshot there is nothing to load.
+  remove(disk_manager->GetSnapshotFileName().c_str());
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_FALSE(bpm->LoadSnapshot());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FetchChildPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  Page *parent = bpm->FetchPage(page_ids[0]);
+  ASSERT_NE(nullptr, parent);
+
+  // Scenario: the first fetch swizzles the slot, and the second one pins the same frame through it.
+  Page *child = bpm->FetchChildPage(parent, 1, page_ids[1]);
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ(child, bpm->FetchChildPage(parent, 1, page_ids[1]));
+  EXPECT_EQ(2, child->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], false));
+
+  // Scenario: once the child has been evicted, the stale reference is noticed and the child is read again.
+  for (size_t i = 2; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  child = bpm->FetchChildPage(parent, 1, page_ids[1]);
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ(page_ids[1], child->GetPageId());
+  EXPECT_EQ("page-" + std::to_string(page_ids[1]), std::string(child->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[1], false));
+
+  // Scenario: a slot that now references another child never hands out the old one.
+  child = bpm->FetchChildPage(parent, 1, page_ids[2]);
+  ASSERT_NE(nullptr, child);
+  EXPECT_EQ("page-" + std::to_string(page_ids[2]), std::string(child->GetData()));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, AsyncDiskManagerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 12;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *async_disk_manager = new AsyncDiskManager(disk_manager, 4);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetAsyncDiskManager(async_disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the background writer writes its batches through the AsyncDiskManager.
+  BackgroundWriterOptions options;
+  options.interval = std::chrono::milliseconds(1);
+  options.batch_size = 5;
+  options.target_clean_ratio = 1.0;
+  bpm->StartBackgroundWriter(options);
+  for (int attempt = 0; attempt < 1000 && disk_manager->GetNumWrites() < num_pages; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  delete bpm;
+
+  // Scenario: a batch fetch reads all its misses at once.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetAsyncDiskManager(async_disk_manager);
+  std::vector<page_id_t> batch(page_ids.begin(), page_ids.begin() + num_pages / 2);
+  std::vector<Page *> pages = bpm->FetchPages(&batch);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page-" + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(batch[i], false));
+  }
+
+  // Scenario: read-ahead completes in the background, and fetches that arrive first wait for it.
+  std::vector<page_id_t> rest(page_ids.begin() + num_pages / 2, page_ids.end());
+  bpm->PrefetchPages(rest);
+  for (auto page_id : rest) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete async_disk_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BackgroundWriterLatchTest) {
+  const size_t buffer_pool_size = 4;
+  const auto write_latency = std::chrono::milliseconds(300);
+
+  MemoryDiskManager memory_disk_manager;
+  SimulatedLatencyOptions latency_options;
+  latency_options.write_latency = write_latency;
+  SimulatedLatencyDiskManager disk_manager(&memory_disk_manager, latency_options);
+  AsyncDiskManager async_disk_manager(&disk_manager, 4);
+  for (bool use_async : {false, true}) {
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, &disk_manager);
+    if (use_async) {
+      bpm->SetAsyncDiskManager(&async_disk_manager);
+    }
+    page_id_t page_a;
+    page_id_t page_b;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_a));
+    ASSERT_NE(nullptr, bpm->NewPage(&page_b));
+    EXPECT_TRUE(bpm->UnpinPage(page_a, true));
+    EXPECT_TRUE(bpm->UnpinPage(page_b, true));
+    const int num_writes = disk_manager.GetNumWrites();
+
+    // Scenario: while the writer's batch of both pages is on its way to disk, synchronously or not, a thread crabs
+    // from one page to the other with write latches, without waiting for the writes.
+    BackgroundWriterOptions options;
+    options.interval = std::chrono::milliseconds(1);
+    options.batch_size = 2;
+    options.target_clean_ratio = 1.0;
+    bpm->StartBackgroundWriter(options);
+    std::this_thread::sleep_for(write_latency / 6);
+    const auto start = std::chrono::steady_clock::now();
+    Page *b = bpm->FetchPage(page_b);
+    ASSERT_NE(nullptr, b);
+    b->WLatch();
+    Page *a = bpm->FetchPage(page_a);
+    ASSERT_NE(nullptr, a);
+    a->WLatch();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, write_latency / 2) << "async " << use_async;
+    a->WUnlatch();
+    b->WUnlatch();
+    EXPECT_TRUE(bpm->UnpinPage(page_a, false));
+    EXPECT_TRUE(bpm->UnpinPage(page_b, false));
+    bpm->StopBackgroundWriter();
+    EXPECT_EQ(num_writes + 2, disk_manager.GetNumWrites());
+
+    delete bpm;
+  }
+}
+
+/** A MemoryDiskManager whose batch writes fail while fail_ is set. */
+class FailingDiskManager : public MemoryDiskManager {
+ public:
+  std::vector<bool> WritePages(const std::vector<page_id_t> &page_ids,
+                               const std::vector<const char *> &pages) override {
+    if (fail_) {
+      return std::vector<bool>(page_ids.size(), false);
+    }
+    return MemoryDiskManager::WritePages(page_ids, pages);
+  }
+
+  std::atomic<bool> fail_{true};
+};
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, WriteFailureTest) {
+  const size_t buffer_pool_size = 4;
+
+  FailingDiskManager disk_manager;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, &disk_manager);
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  auto expect_dirty = [&]() {
+    for (auto page_id : page_ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_TRUE(page->IsDirty());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  };
+
+  // Scenario: pages that a flush fails to write stay dirty.
+  bpm->FlushAllPages();
+  expect_dirty();
+
+  // Scenario: so do pages that the background writer fails to write.
+  BackgroundWriterOptions options;
+  options.interval = std::chrono::milliseconds(1);
+  options.target_clean_ratio = 1.0;
+  bpm->StartBackgroundWriter(options);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bpm->StopBackgroundWriter();
+  expect_dirty();
+
+  // Scenario: once the disk works again, evicting the pages writes them, and their content survives.
+  disk_manager.fail_ = false;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (auto page_id : page_ids) {
+    char data[PAGE_SIZE];
+    disk_manager.ReadPage(page_id, data);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(data));
+  }
+
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MemoryDiskManagerTest) {
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+
+  MemoryDiskManager memory_disk_manager;
+  SimulatedLatencyOptions options;
+  options.read_latency = std::chrono::microseconds(50);
+  options.write_latency = std::chrono::microseconds(50);
+  SimulatedLatencyDiskManager disk_manager(&memory_disk_manager, options);
+  AsyncDiskManager async_disk_manager(&disk_manager, 4);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, &disk_manager);
+  bpm->SetAsyncDiskManager(&async_disk_manager);
+
+  // Scenario: the ring needs files, so asynchronous I/O goes through the thread pool instead.
+  EXPECT_EQ(AsyncDiskManager::Backend::THREAD_POOL, async_disk_manager.GetBackend());
+
+  // Scenario: four times as many pages as frames are written back to memory and read in again, both one by one and
+  // in batches.
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  std::vector<page_id_t> batch(page_ids.begin(), page_ids.begin() + buffer_pool_size / 2);
+  std::vector<Page *> pages = bpm->FetchPages(&batch);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page-" + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(batch[i], false));
+  }
+  EXPECT_EQ(num_pages, memory_disk_manager.GetNumPages());
+  EXPECT_EQ(memory_disk_manager.GetNumWrites(), disk_manager.GetNumWrites());
+
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DirectIOTest) {
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+
+  DiskManagerOptions disk_options;
+  disk_options.direct_io = true;
+  auto *disk_manager = new DiskManager("test.db", disk_options);
+  auto *async_disk_manager = new AsyncDiskManager(disk_manager, 4);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->SetAsyncDiskManager(async_disk_manager);
+
+  // Scenario: every frame is aligned for direct I/O, and pages round-trip through the database file one by one and in
+  // batches, with or without direct I/O support in the file system.
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DIRECT_IO_ALIGNMENT);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%s", std::to_string(page_id).c_str());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  for (auto page_id : page_ids) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page-" + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  std::vector<page_id_t> batch(page_ids.begin(), page_ids.begin() + buffer_pool_size / 2);
+  std::vector<Page *> pages = bpm->FetchPages(&batch);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page-" + std::to_string(batch[i]), std::string(pages[i]->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(batch[i], false));
+  }
+
+  // Scenario: a page on its own is aligned as well.
+  Page page;
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page.GetData()) % DIRECT_IO_ALIGNMENT);
+
+  delete bpm;
+  delete async_disk_manager;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
 }  // namespace bustub
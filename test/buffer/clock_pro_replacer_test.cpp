@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_pro_replacer_test.cpp
+//
+// Identification: test/buffer/clock_pro_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include "buffer/clock_pro_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ClockProReplacerTest, SampleTest) {
+  ClockProReplacer clock_pro_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  for (int i = 1; i <= 6; ++i) {
+    clock_pro_replacer.Unpin(i);
+  }
+  clock_pro_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_pro_replacer.Size());
+
+  // Scenario: nothing has been re-referenced, so the victims come out in clock order.
+  int value;
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 2 has already been victimized, so pinning 2 should have no effect.
+  clock_pro_replacer.Pin(2);
+  clock_pro_replacer.Pin(3);
+  EXPECT_EQ(3, clock_pro_replacer.Size());
+
+  // Scenario: 3 is referenced again within its test period, so it is promoted to hot and outlives 4, 5 and 6.
+  clock_pro_replacer.Unpin(3);
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: once only hot frames are left, they are demoted and victimized.
+  ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, clock_pro_replacer.Size());
+  EXPECT_FALSE(clock_pro_replacer.Victim(&value));
+}
+
+TEST(ClockProReplacerTest, ScanResistanceTest) {
+  const int num_frames = 8;
+  const int num_hot = 4;
+  ClockProReplacer clock_pro_replacer(num_frames);
+
+  // Scenario: frames 0-3 hold a working set that is accessed over and over, frames 4-7 hold pages of a scan.
+  for (int i = 0; i < num_frames; ++i) {
+    clock_pro_replacer.Unpin(i);
+  }
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < num_hot; ++i) {
+      clock_pro_replacer.Pin(i);
+      clock_pro_replacer.Unpin(i);
+    }
+  }
+
+  // Scenario: a long scan keeps asking for victims and touches every page exactly once. The working set survives.
+  std::set<int> victims;
+  for (int i = 0; i < 10 * num_frames; ++i) {
+    int value;
+    ASSERT_TRUE(clock_pro_replacer.Victim(&value));
+    victims.insert(value);
+    clock_pro_replacer.Unpin(value);
+  }
+  for (int i = 0; i < num_hot; ++i) {
+    EXPECT_EQ(0, victims.count(i));
+  }
+  EXPECT_EQ(num_frames, clock_pro_replacer.Size());
+}
+
+TEST(ClockProReplacerTest, ResizeTest) {
+  ClockProReplacer clock_pro_replacer(4);
+  for (int i = 0; i < 4; ++i) {
+    clock_pro_replacer.Unpin(i);
+  }
+
+  // Scenario: shrinking forgets the frames that go away, even though they were in the replacer.
+  clock_pro_replacer.Resize(2);
+  EXPECT_EQ(2, clock_pro_replacer.Size());
+
+  // Scenario: frames added by growing can be unpinned and victimized like the others.
+  clock_pro_replacer.Resize(6);
+  clock_pro_replacer.Unpin(5);
+  EXPECT_EQ(3, clock_pro_replacer.Size());
+  std::vector<int> victims(3);
+  for (auto &victim : victims) {
+    EXPECT_TRUE(clock_pro_replacer.Victim(&victim));
+  }
+  std::sort(victims.begin(), victims.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 5}), victims);
+  EXPECT_EQ(0, clock_pro_replacer.Size());
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
 #include <thread>  // NOLINT
 #include <vector>
@@ -19,7 +20,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +60,49 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ResizeTest) {
+  ClockReplacer clock_replacer(4);
+  for (int i = 0; i < 4; ++i) {
+    clock_replacer.Unpin(i);
+  }
+
+  // Scenario: shrinking forgets the frames that go away, even though they were in the replacer.
+  clock_replacer.Resize(2);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: frames added by growing can be unpinned and victimized like the others.
+  clock_replacer.Resize(6);
+  clock_replacer.Unpin(5);
+  EXPECT_EQ(3, clock_replacer.Size());
+  std::vector<int> victims(3);
+  for (auto &victim : victims) {
+    EXPECT_TRUE(clock_replacer.Victim(&victim));
+  }
+  std::sort(victims.begin(), victims.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 5}), victims);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, VictimOrderTest) {
+  ClockReplacer clock_replacer(6);
+  for (int i : {3, 1, 4, 0, 5}) {
+    clock_replacer.Unpin(i);
+  }
+  // Let the hand clear the reference bits, then reference 1 again.
+  int victim;
+  clock_replacer.Victim(&victim);
+  clock_replacer.Pin(1);
+  clock_replacer.Unpin(1);
+  // Scenario: the victim order is what Victim returns next, one by one, and listing it changes nothing.
+  std::vector<frame_id_t> order;
+  clock_replacer.GetVictimOrder(&order);
+  EXPECT_EQ(order.size(), clock_replacer.Size());
+  std::vector<frame_id_t> victims;
+  int value;
+  while (clock_replacer.Victim(&value)) {
+    victims.push_back(value);
+  }
+  EXPECT_EQ(victims, order);
+}
+
 }  // namespace bustub
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table_test.cpp
+//
+// Identification: test/buffer/concurrent_page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/concurrent_page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ConcurrentPageTableTest, SampleTest) {
+  ConcurrentPageTable page_table(16);
+  frame_id_t frame_id;
+
+  // Scenario: insert a few pages and find them again.
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  page_table.Insert(0, 3);
+  page_table.Insert(7, 1);
+  page_table.Insert(42, 0);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(0, &frame_id));
+  EXPECT_EQ(3, frame_id);
+  ASSERT_TRUE(page_table.Find(7, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  ASSERT_TRUE(page_table.Find(42, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  // Scenario: inserting a page again moves it to the new frame.
+  page_table.Insert(7, 5);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(7, &frame_id));
+  EXPECT_EQ(5, frame_id);
+
+  // Scenario: erase pages, including one that is not there.
+  EXPECT_TRUE(page_table.Erase(0));
+  EXPECT_FALSE(page_table.Erase(0));
+  EXPECT_FALSE(page_table.Erase(1));
+  EXPECT_EQ(2, page_table.Size());
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+  ASSERT_TRUE(page_table.Find(42, &frame_id));
+  EXPECT_EQ(0, frame_id);
+}
+
+TEST(ConcurrentPageTableTest, FullTableTest) {
+  // A full table has long probe sequences that wrap around the end of the array, which exercises the backward shift
+  // of Erase. Compare against std::unordered_map after every operation.
+  const size_t max_entries = 64;
+  ConcurrentPageTable page_table(max_entries);
+  std::unordered_map<page_id_t, frame_id_t> reference;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 255);
+  for (int round = 0; round < 20000; ++round) {
+    const page_id_t page_id = page_dist(rng);
+    if (reference.count(page_id) != 0) {
+      EXPECT_TRUE(page_table.Erase(page_id));
+      reference.erase(page_id);
+    } else if (reference.size() < max_entries) {
+      page_table.Insert(page_id, round);
+      reference[page_id] = round;
+    }
+    ASSERT_EQ(reference.size(), page_table.Size());
+    if (round % 100 == 0) {
+      for (page_id_t probe = 0; probe < 256; ++probe) {
+        frame_id_t frame_id;
+        auto it = reference.find(probe);
+        ASSERT_EQ(it != reference.end(), page_table.Find(probe, &frame_id));
+        if (it != reference.end()) {
+          EXPECT_EQ(it->second, frame_id);
+        }
+      }
+    }
+  }
+}
+
+TEST(ConcurrentPageTableTest, ReserveTest) {
+  ConcurrentPageTable page_table(4);
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    page_table.Insert(page_id, page_id + 100);
+  }
+
+  // Scenario: reserving no more than the table holds keeps it as it is.
+  page_table.Reserve(2);
+  page_table.Reserve(4);
+  EXPECT_EQ(4, page_table.Size());
+
+  // Scenario: growing keeps the entries, and makes room for more.
+  page_table.Reserve(1000);
+  EXPECT_EQ(4, page_table.Size());
+  for (page_id_t page_id = 4; page_id < 1000; ++page_id) {
+    page_table.Insert(page_id, page_id + 100);
+  }
+  EXPECT_EQ(1000, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 1000; ++page_id) {
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id + 100, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(1000, &frame_id));
+  for (page_id_t page_id = 0; page_id < 1000; page_id += 2) {
+    EXPECT_TRUE(page_table.Erase(page_id));
+  }
+  EXPECT_EQ(500, page_table.Size());
+  for (page_id_t page_id = 0; page_id < 1000; ++page_id) {
+    EXPECT_EQ(page_id % 2 == 1, page_table.Find(page_id, &frame_id));
+  }
+}
+
+TEST(ConcurrentPageTableTest, ConcurrentFindTest) {
+  // Readers look up pages that are always present while a writer keeps inserting and erasing others around them. The
+  // readers may miss a page while it is being moved, but must never see it mapped to a wrong frame.
+  const size_t max_entries = 256;
+  ConcurrentPageTable page_table(max_entries);
+  for (page_id_t page_id = 0; page_id < 64; ++page_id) {
+    page_table.Insert(page_id, page_id + 1000);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<size_t> hits{0};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.emplace_back([&, tid] {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<page_id_t> dist(0, 63);
+      while (!done) {
+        const page_id_t page_id = dist(rng);
+        frame_id_t frame_id;
+        if (page_table.Find(page_id, &frame_id)) {
+          EXPECT_EQ(page_id + 1000, frame_id);
+          ++hits;
+        }
+      }
+    });
+  }
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<page_id_t> dist(64, 64 + max_entries);
+  std::vector<page_id_t> inserted;
+  for (int round = 0; round < 20000; ++round) {
+    if (inserted.size() < max_entries - 64 && (inserted.empty() || rng() % 2 == 0)) {
+      const page_id_t page_id = dist(rng);
+      if (std::find(inserted.begin(), inserted.end(), page_id) == inserted.end()) {
+        page_table.Insert(page_id, page_id);
+        inserted.push_back(page_id);
+      }
+    } else {
+      std::swap(inserted[rng() % inserted.size()], inserted.back());
+      page_table.Erase(inserted.back());
+      inserted.pop_back();
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_GT(hits, 0);
+  for (page_id_t page_id = 0; page_id < 64; ++page_id) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(page_id + 1000, frame_id);
+  }
+}
+
+}  // namespace bustub
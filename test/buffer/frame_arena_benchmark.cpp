@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_benchmark.cpp
+//
+// Identification: test/buffer/frame_arena_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+// Measures the FetchPage/UnpinPage throughput of a ParallelBufferPoolManager when every fetch is a hit, for each huge
+// page mode of the frame arena. The pool is large and the accesses are uniformly random, so the data reads miss the
+// TLB unless the frames are mapped with huge pages. HugePageMode::NONE is the baseline.
+
+namespace bustub {
+
+static double RunHits(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                      uint64_t ops_per_thread) {
+  return RunThreads(num_threads, [&](size_t tid) {
+    std::mt19937_64 rng(tid);
+    std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      page_id_t page_id = page_ids[dist(rng)];
+      Page *page = bpm->FetchPage(page_id);
+      page->RLatch();
+      // Touch a different cache line of the data on every access.
+      volatile char c = page->GetData()[(i * 64) % PAGE_SIZE];
+      (void)c;
+      page->RUnlatch();
+      bpm->UnpinPage(page_id, false);
+    }
+  });
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t max_threads = args.GetInt("threads", std::thread::hardware_concurrency());
+  const uint64_t num_instances = args.GetInt("instances", 8);
+  const uint64_t pool_size = args.GetInt("pool_size", 32768);
+  const uint64_t ops_per_thread = args.GetInt("ops", 1000000);
+  const bool numa_local = args.GetInt("numa_local", 0) != 0;
+  const std::string db_name = args.GetString("db", "frame_arena_bench.db");
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  const std::vector<std::pair<const char *, bustub::HugePageMode>> modes = {
+      {"none", bustub::HugePageMode::NONE},
+      {"transparent", bustub::HugePageMode::TRANSPARENT},
+      {"explicit", bustub::HugePageMode::EXPLICIT},
+  };
+  auto disk_manager = std::make_unique<bustub::DiskManager>(db_name);
+  printf("%8s", "threads");
+  for (const auto &[name, mode] : modes) {
+    printf(" %14s", (std::string(name) + " op/s").c_str());
+  }
+  printf("\n");
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    printf("%8lu", threads);
+    for (const auto &[name, mode] : modes) {
+      bustub::FrameArenaOptions options;
+      options.huge_pages = mode;
+      options.numa_local_instances = numa_local;
+      bustub::ParallelBufferPoolManager bpm(num_instances, pool_size / num_instances, disk_manager.get(), nullptr,
+                                            bustub::BufferPoolManager::ReplacementPolicy::LRU, options);
+      // Fill the pool with new pages; they stay resident, so every fetch below is a hit.
+      std::vector<bustub::page_id_t> page_ids;
+      for (uint64_t i = 0; i < bpm.GetPoolSize(); ++i) {
+        bustub::page_id_t page_id;
+        if (bpm.NewPage(&page_id) == nullptr) {
+          break;
+        }
+        bpm.UnpinPage(page_id, false);
+        page_ids.push_back(page_id);
+      }
+      double secs = bustub::RunHits(&bpm, page_ids, threads, ops_per_thread);
+      printf(" %14.0f", static_cast<double>(threads * ops_per_thread) / secs);
+    }
+    printf("\n");
+    if (threads * 2 > max_threads && threads != max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  return 0;
+}
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_benchmark.cpp
+//
+// Identification: test/buffer/lru_k_replacer_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/clock_pro_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+
+// Compares the hit ratio of the replacers on a mix of index point lookups and sequential table scans. The buffer pool
+// is simulated with a page table on top of the replacer, so no disk I/O is involved and the reported time is the
+// replacer's own overhead.
+//
+// Every lookup descends a three-level index (root, one of the inner pages, one of the leaves) and then reads one
+// random table page, the way NestIndexJoinExecutor does. Between lookups, a scan reads the next few table pages in
+// order, the way SeqScanExecutor does.
+
+namespace bustub {
+
+struct SimulationResult {
+  uint64_t accesses_{0};
+  uint64_t hits_{0};
+  double seconds_{0};
+};
+
+class BufferPoolSimulator {
+ public:
+  BufferPoolSimulator(Replacer *replacer, size_t pool_size) : replacer_(replacer), page_ids_(pool_size) {
+    for (size_t i = 0; i < pool_size; ++i) {
+      free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  /** Fetches and immediately unpins page_id. */
+  void Access(page_id_t page_id) {
+    ++result_.accesses_;
+    auto it = page_table_.find(page_id);
+    frame_id_t frame_id;
+    if (it != page_table_.end()) {
+      ++result_.hits_;
+      frame_id = it->second;
+    } else {
+      if (!free_list_.empty()) {
+        frame_id = free_list_.back();
+        free_list_.pop_back();
+      } else {
+        replacer_->Victim(&frame_id);
+        page_table_.erase(page_ids_[frame_id]);
+      }
+      page_table_[page_id] = frame_id;
+      page_ids_[frame_id] = page_id;
+    }
+    replacer_->Pin(frame_id);
+    replacer_->Unpin(frame_id);
+  }
+
+  SimulationResult *GetResult() { return &result_; }
+
+ private:
+  Replacer *replacer_;
+  std::vector<page_id_t> page_ids_;
+  std::vector<frame_id_t> free_list_;
+  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  SimulationResult result_;
+};
+
+static SimulationResult Simulate(Replacer *replacer, size_t pool_size, uint64_t lookups, uint64_t inner_pages,
+                                 uint64_t leaf_pages, uint64_t table_pages, uint64_t scan_pages_per_lookup) {
+  BufferPoolSimulator simulator(replacer, pool_size);
+  std::mt19937_64 rng(15445);
+  std::uniform_int_distribution<uint64_t> inner(0, inner_pages - 1);
+  std::uniform_int_distribution<uint64_t> leaf(0, leaf_pages - 1);
+  std::uniform_int_distribution<uint64_t> table(0, table_pages - 1);
+  // Index pages come first, table pages after them.
+  const page_id_t first_leaf = 1 + inner_pages;
+  const page_id_t first_table_page = first_leaf + leaf_pages;
+  uint64_t scan_position = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < lookups; ++i) {
+    simulator.Access(0);
+    simulator.Access(1 + inner(rng));
+    simulator.Access(first_leaf + leaf(rng));
+    simulator.Access(first_table_page + table(rng));
+    for (uint64_t j = 0; j < scan_pages_per_lookup; ++j) {
+      simulator.Access(first_table_page + scan_position);
+      scan_position = (scan_position + 1) % table_pages;
+    }
+  }
+  SimulationResult result = *simulator.GetResult();
+  result.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t pool_size = args.GetInt("pool_size", 1024);
+  const uint64_t lookups = args.GetInt("lookups", 200000);
+  const uint64_t inner_pages = args.GetInt("inner_pages", 32);
+  const uint64_t leaf_pages = args.GetInt("leaf_pages", 512);
+  const uint64_t table_pages = args.GetInt("table_pages", 65536);
+  const uint64_t scan_pages = args.GetInt("scan_pages_per_lookup", 4);
+  const uint64_t k = args.GetInt("k", bustub::LRUK_REPLACER_K);
+  const uint64_t correlated_period = args.GetInt("correlated_period", bustub::LRUK_CORRELATED_PERIOD);
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  std::vector<std::pair<std::string, std::unique_ptr<bustub::Replacer>>> replacers;
+  replacers.emplace_back("lru", std::make_unique<bustub::LRUReplacer>(pool_size));
+  replacers.emplace_back("lru-k", std::make_unique<bustub::LRUKReplacer>(pool_size, k, correlated_period));
+  replacers.emplace_back("clock", std::make_unique<bustub::ClockReplacer>(pool_size));
+  replacers.emplace_back("clock-pro", std::make_unique<bustub::ClockProReplacer>(pool_size));
+
+  printf("%lu index pages, %lu table pages, %lu frames\n", 1 + inner_pages + leaf_pages, table_pages, pool_size);
+  printf("%10s %10s %14s\n", "replacer", "hit ratio", "accesses/s");
+  for (auto &[name, replacer] : replacers) {
+    auto result =
+        bustub::Simulate(replacer.get(), pool_size, lookups, inner_pages, leaf_pages, table_pages, scan_pages);
+    printf("%10s %9.2f%% %14.0f\n", name.c_str(), 100.0 * result.hits_ / result.accesses_,
+           result.accesses_ / result.seconds_);
+  }
+  return 0;
+}
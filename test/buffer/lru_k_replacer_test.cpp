@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 0);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: reference 1, 2 and 3 a second time. They now have a finite backward 2-distance, 4, 5 and 6 do not.
+  for (int i = 1; i <= 3; ++i) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference are evicted first, in the order they were referenced.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 4 has already been victimized, so pinning 4 should have no effect.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: 1 is referenced a third time, so its second most recent reference is now younger than those of 2 and 3.
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a victimized frame starts over with an empty history.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 3);
+  int value;
+
+  // Scenario: frame 0 is pinned and unpinned three times in a row, as during one B+ tree descent. The references are
+  // correlated, so frame 0 still has only one reference in its history.
+  for (int i = 0; i < 3; ++i) {
+    lru_k_replacer.Pin(0);
+    lru_k_replacer.Unpin(0);
+  }
+  // Scenario: frames 2 and 3 are re-referenced shortly after their first reference, frame 1 only much later.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+
+  // Only frame 1 has two uncorrelated references. Frames 0, 2 and 3 have an infinite backward 2-distance and are
+  // evicted first, in the order of their first reference.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, ConcurrencyTest) {
+  const int num_threads = 4;
+  const int num_frames = 64;
+  LRUKReplacer lru_k_replacer(num_frames);
+
+  // Scenario: every thread owns a disjoint set of frames and unpins, pins and re-unpins them concurrently.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&lru_k_replacer, tid] {
+      for (int round = 0; round < 100; ++round) {
+        for (int frame = tid; frame < num_frames; frame += num_threads) {
+          lru_k_replacer.Unpin(frame);
+          lru_k_replacer.Pin(frame);
+          lru_k_replacer.Unpin(frame);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_frames, lru_k_replacer.Size());
+
+  int value;
+  for (int i = 0; i < num_frames; ++i) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  }
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, ResizeTest) {
+  LRUKReplacer lru_k_replacer(4);
+  for (int i = 0; i < 4; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+
+  // Scenario: shrinking forgets the frames that go away, even though they were in the replacer.
+  lru_k_replacer.Resize(2);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: frames added by growing can be unpinned and victimized like the others.
+  lru_k_replacer.Resize(6);
+  lru_k_replacer.Unpin(5);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  std::vector<int> victims(3);
+  for (auto &victim : victims) {
+    EXPECT_TRUE(lru_k_replacer.Victim(&victim));
+  }
+  std::sort(victims.begin(), victims.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 5}), victims);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, VictimOrderTest) {
+  LRUKReplacer lru_k_replacer(6, 2, 0);
+  for (int i : {3, 1, 4, 0, 5}) {
+    lru_k_replacer.Unpin(i);
+  }
+  // Give 4 and 0 a second reference.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Pin(0);
+  lru_k_replacer.Unpin(0);
+  // Scenario: the victim order is what Victim returns next, one by one, and listing it changes nothing.
+  std::vector<frame_id_t> order;
+  lru_k_replacer.GetVictimOrder(&order);
+  EXPECT_EQ(order.size(), lru_k_replacer.Size());
+  std::vector<frame_id_t> victims;
+  int value;
+  while (lru_k_replacer.Victim(&value)) {
+    victims.push_back(value);
+  }
+  EXPECT_EQ(victims, order);
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
 #include <thread>  // NOLINT
 #include <vector>
@@ -59,4 +60,48 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(LRUReplacerTest, ResizeTest) {
+  LRUReplacer lru_replacer(4);
+  for (int i = 0; i < 4; ++i) {
+    lru_replacer.Unpin(i);
+  }
+
+  // Scenario: shrinking forgets the frames that go away, even though they were in the replacer.
+  lru_replacer.Resize(2);
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // Scenario: frames added by growing can be unpinned and victimized like the others.
+  lru_replacer.Resize(6);
+  lru_replacer.Unpin(5);
+  EXPECT_EQ(3, lru_replacer.Size());
+  std::vector<int> victims(3);
+  for (auto &victim : victims) {
+    EXPECT_TRUE(lru_replacer.Victim(&victim));
+  }
+  std::sort(victims.begin(), victims.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 5}), victims);
+  EXPECT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUReplacerTest, VictimOrderTest) {
+  LRUReplacer lru_replacer(6);
+  for (int i : {3, 1, 4, 0, 5}) {
+    lru_replacer.Unpin(i);
+  }
+  // Touch 1 again and take 4 out.
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.Pin(4);
+  // Scenario: the victim order is what Victim returns next, one by one, and listing it changes nothing.
+  std::vector<frame_id_t> order;
+  lru_replacer.GetVictimOrder(&order);
+  EXPECT_EQ(order.size(), lru_replacer.Size());
+  std::vector<frame_id_t> victims;
+  int value;
+  while (lru_replacer.Victim(&value)) {
+    victims.push_back(value);
+  }
+  EXPECT_EQ(victims, order);
+}
+
 }  // namespace bustub
@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  // Scenario: the check value of CRC-32C, and the test vectors of RFC 3720, appendix B.4.
+  const std::string check = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32c::Value(check.data(), check.size()));
+  EXPECT_EQ(0xE3069283, Crc32c::ExtendPortable(0, check.data(), check.size()));
+  const std::vector<char> zeroes(32, 0);
+  const std::vector<char> ones(32, static_cast<char>(0xFF));
+  std::vector<char> ascending(32);
+  for (size_t i = 0; i < ascending.size(); ++i) {
+    ascending[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x8A9136AA, Crc32c::Value(zeroes.data(), zeroes.size()));
+  EXPECT_EQ(0x62A8AB43, Crc32c::Value(ones.data(), ones.size()));
+  EXPECT_EQ(0x46DD794E, Crc32c::Value(ascending.data(), ascending.size()));
+  EXPECT_EQ(0, Crc32c::Value(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, PortableMatchesHardwareTest) {
+  std::mt19937 rng(0);
+  std::vector<char> data(1000);
+  for (auto &c : data) {
+    c = static_cast<char>(rng());
+  }
+  // Scenario: both implementations agree for every alignment and every length, including the byte-wise tails.
+  for (size_t begin = 0; begin < 16; ++begin) {
+    for (size_t length = 0; begin + length <= data.size(); length += 1 + length / 8) {
+      ASSERT_EQ(Crc32c::ExtendPortable(0, data.data() + begin, length), Crc32c::Extend(0, data.data() + begin, length))
+          << "begin " << begin << ", length " << length;
+    }
+  }
+  // Scenario: extending a CRC piece by piece is the same as computing it at once.
+  uint32_t crc = 0;
+  for (size_t begin = 0; begin < data.size(); begin += 37) {
+    crc = Crc32c::Extend(crc, data.data() + begin, std::min<size_t>(37, data.size() - begin));
+  }
+  EXPECT_EQ(Crc32c::Value(data.data(), data.size()), crc);
+}
+
+}  // namespace bustub
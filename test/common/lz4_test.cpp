@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz4_test.cpp
+//
+// Identification: test/common/lz4_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/lz4.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, RoundTripTest) {
+  std::mt19937 rng(0);
+  std::vector<std::string> inputs;
+  inputs.emplace_back(4096, 'a');
+  std::string tuples;
+  while (tuples.size() < 4096) {
+    tuples += "customer#" + std::to_string(rng() % 1000) + "|BUILDING|";
+  }
+  inputs.push_back(tuples);
+  std::string noise(4096, '\0');
+  for (auto &c : noise) {
+    c = static_cast<char>(rng());
+  }
+  inputs.push_back(noise);
+  inputs.emplace_back("tiny");
+  inputs.emplace_back("");
+
+  // Scenario: repetitive data shrinks, random data does not, and everything decompresses to what it was.
+  for (const auto &input : inputs) {
+    std::vector<char> block(input.size() + input.size() / 255 + 16);
+    const size_t size = Lz4::Compress(input.data(), input.size(), block.data(), block.size());
+    ASSERT_GT(size, 0);
+    std::string output(input.size(), '\0');
+    ASSERT_TRUE(Lz4::Decompress(block.data(), size, output.data(), output.size()));
+    EXPECT_EQ(input, output);
+  }
+  std::vector<char> block(4096);
+  EXPECT_LT(Lz4::Compress(inputs[0].data(), inputs[0].size(), block.data(), block.size()), 64);
+  EXPECT_LT(Lz4::Compress(inputs[1].data(), inputs[1].size(), block.data(), block.size()), 2048);
+
+  // Scenario: data that does not compress into the capacity is reported as such.
+  EXPECT_EQ(0, Lz4::Compress(noise.data(), noise.size(), block.data(), 4000));
+}
+
+// NOLINTNEXTLINE
+TEST(Lz4Test, DamagedBlockTest) {
+  // Scenario: a hand-made block of one literal and a match of the distance 1, then the last literals.
+  const char block[] = {0x11, 'a', 0x01, 0x00, 0x50, 'b', 'c', 'd', 'e', 'f'};
+  std::string output(11, '\0');
+  ASSERT_TRUE(Lz4::Decompress(block, sizeof(block), output.data(), output.size()));
+  EXPECT_EQ("aaaaaabcdef", output);
+
+  // Scenario: a block is only accepted for the exact size it decompresses to.
+  std::string longer(12, '\0');
+  EXPECT_FALSE(Lz4::Decompress(block, sizeof(block), longer.data(), longer.size()));
+  EXPECT_FALSE(Lz4::Decompress(block, sizeof(block), output.data(), 10));
+
+  // Scenario: truncated blocks and matches that reach back before the output are rejected, not followed.
+  for (size_t size = 0; size < sizeof(block); ++size) {
+    EXPECT_FALSE(Lz4::Decompress(block, size, output.data(), output.size())) << "size " << size;
+  }
+  const char bad_offset[] = {0x11, 'a', 0x02, 0x00, 0x50, 'b', 'c', 'd', 'e', 'f'};
+  EXPECT_FALSE(Lz4::Decompress(bad_offset, sizeof(bad_offset), output.data(), output.size()));
+  const char zero_offset[] = {0x11, 'a', 0x00, 0x00, 0x50, 'b', 'c', 'd', 'e', 'f'};
+  EXPECT_FALSE(Lz4::Decompress(zero_offset, sizeof(zero_offset), output.data(), output.size()));
+}
+
+}  // namespace bustub
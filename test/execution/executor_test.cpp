@@ -18,9 +18,10 @@
 #include <vector>
 
 #include "execution/plans/delete_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/table_generator.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
@@ -47,7 +48,7 @@ class ExecutorTest : public ::testing::Test {
     ::testing::Test::SetUp();
     // For each test, we create a new DiskManager, BufferPoolManager, TransactionManager, and Catalog.
     disk_manager_ = std::make_unique<DiskManager>("executor_test.db");
-    bpm_ = std::make_unique<BufferPoolManager>(32, disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManagerInstance>(32, disk_manager_.get());
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
@@ -71,6 +72,7 @@ class ExecutorTest : public ::testing::Test {
     // Shut down the disk manager and clean up the transaction.
     disk_manager_->ShutDown();
     remove("executor_test.db");
+    remove("executor_test.fsm");
     delete txn_;
   };
 
@@ -332,6 +334,65 @@ TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 500, through an index on colA
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8);
+
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  IndexScanPlanNode scan_plan{out_schema, predicate, index_info->index_oid_};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // The tuples are fetched from the table in batches, but still come out in index order.
+  ASSERT_EQ(result_set.size(), 500);
+  for (size_t i = 0; i < result_set.size(); ++i) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>(), i);
+    ASSERT_LT(result_set[i].GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>(), 10);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, LargeIndexScanTest) {
+  // SELECT colA FROM big through an index on colA, where every tuple takes a page of its own, so that a batch of rids
+  // spans more pages than the buffer pool of 32 frames holds.
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::VARCHAR, PAGE_SIZE / 2)});
+  auto table_info = GetCatalog()->CreateTable(GetTxn(), "big", schema);
+  const int num_tuples = 3 * TUPLE_FETCH_BATCH_SIZE;
+  const std::string padding(PAGE_SIZE / 2, 'x');
+  for (int i = 0; i < num_tuples; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(padding)}, &table_info->schema_);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "big_index", "big", table_info->schema_, *key_schema, {0}, 8);
+
+  auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+  auto out_schema = MakeOutputSchema({{"colA", colA}});
+  IndexScanPlanNode scan_plan{out_schema, nullptr, index_info->index_oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  ASSERT_EQ(result_set.size(), num_tuples);
+  for (size_t i = 0; i < result_set.size(); ++i) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), i);
+  }
+  EXPECT_NE(TransactionState::ABORTED, GetTxn()->GetState());
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// benchmark_util.h
+//
+// Identification: test/include/benchmark/benchmark_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * BenchmarkArgs parses the "--name=value" flags that every benchmark accepts. Flags that are queried are remembered
+ * together with their defaults so that PrintUsage can list them.
+ */
+class BenchmarkArgs {
+ public:
+  BenchmarkArgs(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg(argv[i]);
+      if (arg.rfind("--", 0) != 0) {
+        continue;
+      }
+      auto eq = arg.find('=');
+      if (eq == std::string::npos) {
+        flags_[arg.substr(2)] = "1";
+      } else {
+        flags_[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+      }
+    }
+  }
+
+  /** @return the integer value of flag name, or default_value if it was not passed */
+  uint64_t GetInt(const std::string &name, uint64_t default_value) {
+    defaults_[name] = std::to_string(default_value);
+    auto it = flags_.find(name);
+    return it == flags_.end() ? default_value : std::stoull(it->second);
+  }
+
+  /** @return the string value of flag name, or default_value if it was not passed */
+  std::string GetString(const std::string &name, const std::string &default_value) {
+    defaults_[name] = default_value;
+    auto it = flags_.find(name);
+    return it == flags_.end() ? default_value : it->second;
+  }
+
+  /** @return true if --help was passed */
+  bool WantsHelp() const { return flags_.count("help") != 0; }
+
+  /** Prints every flag that has been queried so far, with its default. */
+  void PrintUsage(const char *benchmark_name) const {
+    printf("usage: %s [--flag=value ...]\n", benchmark_name);
+    for (const auto &[name, value] : defaults_) {
+      printf("  --%s (default: %s)\n", name.c_str(), value.c_str());
+    }
+  }
+
+ private:
+  std::map<std::string, std::string> flags_;
+  std::map<std::string, std::string> defaults_;
+};
+
+/**
+ * Runs fn(thread_id) on num_threads threads and waits for all of them.
+ * @return the wall-clock time in seconds
+ */
+template <typename F>
+double RunThreads(size_t num_threads, F fn) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back(fn, tid);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace bustub
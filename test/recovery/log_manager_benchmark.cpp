@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_benchmark.cpp
+//
+// Identification: test/recovery/log_manager_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "catalog/schema.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+// Measures the AppendLogRecord throughput of threads that append INSERT records, with the flush thread running. The
+// "reserved" mode appends as it is, with a fetch-add reservation per record; the "latched" mode holds one mutex around
+// every append, the way an append under the LogManager's latch would, and is the baseline. The log goes to a
+// MemoryDiskManager by default, so that the writes of the flush thread do not hide the cost of the appends.
+
+namespace bustub {
+
+static double RunAppends(LogManager *log_manager, const Tuple &tuple, bool latched, size_t num_threads,
+                         uint64_t records_per_thread) {
+  std::mutex latch;
+  return RunThreads(num_threads, [&](size_t tid) {
+    const RID rid(static_cast<page_id_t>(tid), 0);
+    for (uint64_t i = 0; i < records_per_thread; ++i) {
+      LogRecord log_record(static_cast<txn_id_t>(tid), INVALID_LSN, LogRecordType::INSERT, rid, tuple);
+      if (latched) {
+        std::scoped_lock guard(latch);
+        log_manager->AppendLogRecord(&log_record);
+      } else {
+        log_manager->AppendLogRecord(&log_record);
+      }
+    }
+  });
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t max_threads = args.GetInt("threads", std::thread::hardware_concurrency());
+  const uint64_t records_per_thread = args.GetInt("records", 200000);
+  const uint64_t tuple_size = args.GetInt("tuple_size", 100);
+  const std::string disk = args.GetString("disk", "memory");
+  const std::string db_name = args.GetString("db", "log_manager_bench.db");
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  bustub::Schema schema({bustub::Column("payload", bustub::TypeId::VARCHAR, tuple_size)});
+  const std::string payload(tuple_size, 'x');
+  const bustub::Tuple tuple({bustub::ValueFactory::GetVarcharValue(payload)}, &schema);
+
+  const std::vector<std::pair<const char *, bool>> modes = {{"latched", true}, {"reserved", false}};
+  printf("%8s", "threads");
+  for (const auto &[name, latched] : modes) {
+    printf(" %14s %10s", (std::string(name) + " rec/s").c_str(), "MB/s");
+  }
+  printf("\n");
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    printf("%8lu", threads);
+    for (const auto &[name, latched] : modes) {
+      // A fresh log for every run, so that a memory log does not pile up.
+      std::unique_ptr<bustub::DiskManager> disk_manager;
+      if (disk == "memory") {
+        disk_manager = std::make_unique<bustub::MemoryDiskManager>();
+      } else {
+        disk_manager = std::make_unique<bustub::DiskManager>(db_name);
+      }
+      bustub::LogManager log_manager(disk_manager.get());
+      log_manager.RunFlushThread();
+      const double secs = bustub::RunAppends(&log_manager, tuple, latched, threads, records_per_thread);
+      log_manager.StopFlushThread();
+      disk_manager->ShutDown();
+      const auto num_records = static_cast<double>(threads * records_per_thread);
+      bustub::LogRecord log_record(0, bustub::INVALID_LSN, bustub::LogRecordType::INSERT, bustub::RID(), tuple);
+      printf(" %14.0f %10.1f", num_records / secs, num_records * log_record.GetSize() / secs / (1 << 20));
+    }
+    printf("\n");
+    if (threads * 2 > max_threads && threads != max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+
+  remove(db_name.c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  return 0;
+}
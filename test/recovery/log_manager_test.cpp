@@ -0,0 +1,228 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** The size of a log record without a body, such as BEGIN or COMMIT. */
+static constexpr int HEADER_SIZE = 20;
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendAndFlushTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+
+  // Scenario: records get consecutive LSNs, and are not on disk until the flush thread writes them.
+  std::vector<lsn_t> lsns;
+  for (txn_id_t txn_id = 0; txn_id < 10; ++txn_id) {
+    LogRecord log_record(txn_id, INVALID_LSN, LogRecordType::BEGIN);
+    lsns.push_back(log_manager.AppendLogRecord(&log_record));
+    EXPECT_EQ(lsns.back(), log_record.GetLSN());
+  }
+  EXPECT_EQ(0, lsns.front());
+  EXPECT_EQ(9, lsns.back());
+  EXPECT_EQ(10, log_manager.GetNextLSN());
+
+  // Scenario: a flush returns once its record is persistent, long before the timeout.
+  const auto start = std::chrono::steady_clock::now();
+  log_manager.Flush(lsns[4]);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, log_timeout);
+  EXPECT_GE(log_manager.GetPersistentLSN(), lsns[4]);
+
+  // Scenario: the records on disk are in the format of log_record.h.
+  char data[HEADER_SIZE * 10];
+  ASSERT_TRUE(disk_manager.ReadLog(data, sizeof(data), 0));
+  for (int i = 0; i < 10; ++i) {
+    int32_t header[5];
+    std::memcpy(header, data + i * HEADER_SIZE, sizeof(header));
+    EXPECT_EQ(HEADER_SIZE, header[0]);
+    EXPECT_EQ(i, header[1]);
+    EXPECT_EQ(i, header[2]);
+    EXPECT_EQ(INVALID_LSN, header[3]);
+    EXPECT_EQ(static_cast<int32_t>(LogRecordType::BEGIN), header[4]);
+  }
+
+  // Scenario: records that nobody waits for are written on the timeout.
+  LogRecord log_record(10, INVALID_LSN, LogRecordType::ABORT);
+  const lsn_t lsn = log_manager.AppendLogRecord(&log_record);
+  for (int attempt = 0; attempt < 300 && log_manager.GetPersistentLSN() < lsn; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, BufferFullTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  const int num_records = 4 * LOG_BUFFER_SIZE / HEADER_SIZE;
+
+  // Scenario: without a flush thread, a full buffer is written by the appender that needs the room.
+  for (int i = 0; i < num_records / 2; ++i) {
+    LogRecord log_record(i, INVALID_LSN, LogRecordType::BEGIN);
+    log_manager.AppendLogRecord(&log_record);
+  }
+  EXPECT_GE(disk_manager.GetNumFlushes(), 1);
+
+  // Scenario: with the flush thread, a full buffer wakes it, and the appenders wait for the swap.
+  log_manager.RunFlushThread();
+  for (int i = num_records / 2; i < num_records; ++i) {
+    LogRecord log_record(i, INVALID_LSN, LogRecordType::BEGIN);
+    log_manager.AppendLogRecord(&log_record);
+  }
+  log_manager.StopFlushThread();
+  EXPECT_EQ(num_records - 1, log_manager.GetPersistentLSN());
+
+  // Scenario: nothing was lost or written twice.
+  char data[HEADER_SIZE];
+  EXPECT_TRUE(disk_manager.ReadLog(data, sizeof(data), int64_t{num_records - 1} * HEADER_SIZE));
+  int32_t lsn;
+  std::memcpy(&lsn, data + sizeof(int32_t), sizeof(lsn));
+  EXPECT_EQ(num_records - 1, lsn);
+  EXPECT_FALSE(disk_manager.ReadLog(data, sizeof(data), int64_t{num_records} * HEADER_SIZE));
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: threads append records of two sizes at once, through many swaps of the buffer.
+  const int num_threads = 8;
+  const int records_per_thread = 2 * LOG_BUFFER_SIZE / HEADER_SIZE;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&log_manager, tid] {
+      for (int i = 0; i < records_per_thread; ++i) {
+        if (i % 2 == 0) {
+          LogRecord log_record(tid, INVALID_LSN, LogRecordType::BEGIN);
+          log_manager.AppendLogRecord(&log_record);
+        } else {
+          LogRecord log_record(tid, INVALID_LSN, LogRecordType::NEWPAGE, i, i);
+          log_manager.AppendLogRecord(&log_record);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_manager.StopFlushThread();
+  const int num_records = num_threads * records_per_thread;
+  EXPECT_EQ(num_records, log_manager.GetNextLSN());
+  EXPECT_EQ(num_records - 1, log_manager.GetPersistentLSN());
+
+  // Scenario: the log holds every record once, complete, in the order of the LSNs, which have no gaps.
+  std::vector<int> next_record(num_threads, 0);
+  int64_t offset = 0;
+  for (lsn_t expected_lsn = 0; expected_lsn < num_records; ++expected_lsn) {
+    int32_t header[7];
+    ASSERT_TRUE(disk_manager.ReadLog(reinterpret_cast<char *>(header), sizeof(header), offset));
+    EXPECT_EQ(expected_lsn, header[1]);
+    const txn_id_t tid = header[2];
+    ASSERT_TRUE(tid >= 0 && tid < num_threads);
+    const int i = next_record[tid]++;
+    if (i % 2 == 0) {
+      EXPECT_EQ(HEADER_SIZE, header[0]);
+      EXPECT_EQ(static_cast<int32_t>(LogRecordType::BEGIN), header[4]);
+    } else {
+      EXPECT_EQ(HEADER_SIZE + 2 * static_cast<int>(sizeof(page_id_t)), header[0]);
+      EXPECT_EQ(static_cast<int32_t>(LogRecordType::NEWPAGE), header[4]);
+      EXPECT_EQ(i, header[5]);
+      EXPECT_EQ(i, header[6]);
+    }
+    offset += header[0];
+  }
+  char data[HEADER_SIZE];
+  EXPECT_FALSE(disk_manager.ReadLog(data, sizeof(data), offset));
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager transaction_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: a transaction logs its begin and its commit, and is committed once the commit record is on disk.
+  Transaction *txn = transaction_manager.Begin();
+  const lsn_t begin_lsn = txn->GetPrevLSN();
+  transaction_manager.Commit(txn);
+  EXPECT_EQ(begin_lsn + 1, txn->GetPrevLSN());
+  EXPECT_GE(log_manager.GetPersistentLSN(), txn->GetPrevLSN());
+  delete txn;
+
+  // Scenario: commits that overlap share the writes of the log, rather than syncing once each.
+  const int num_threads = 8;
+  const int commits_per_thread = 50;
+  const int num_flushes = disk_manager.GetNumFlushes();
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&log_manager, tid] {
+      for (int i = 0; i < commits_per_thread; ++i) {
+        LogRecord log_record(tid, INVALID_LSN, LogRecordType::COMMIT);
+        const lsn_t lsn = log_manager.AppendLogRecord(&log_record);
+        log_manager.Flush(lsn);
+        EXPECT_GE(log_manager.GetPersistentLSN(), lsn);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(2 + num_threads * commits_per_thread, log_manager.GetNextLSN());
+  EXPECT_LT(disk_manager.GetNumFlushes() - num_flushes, num_threads * commits_per_thread);
+
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+}  // namespace bustub
@@ -32,6 +32,8 @@ class RecoveryTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.snapshot");
   }
 
   // This function is called after every test.
@@ -39,6 +41,8 @@ class RecoveryTest : public ::testing::Test {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.snapshot");
   };
 };
 
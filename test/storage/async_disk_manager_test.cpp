@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstring>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+// Both backends must behave exactly like the synchronous calls of DiskManagerTest. The IO_URING runs fall back to the
+// thread pool where the kernel refuses io_uring, so they pass either way.
+class AsyncDiskManagerTest : public ::testing::TestWithParam<AsyncDiskManager::Backend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageTest) {
+  char buf[PAGE_SIZE];
+  char data[PAGE_SIZE] = {0};
+  DiskManager dm("test.db");
+  AsyncDiskManager async_dm(&dm, 4, GetParam());
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a page beyond the end of the file reads as zeroes.
+  std::memset(buf, 1, sizeof(buf));
+  EXPECT_TRUE(async_dm.ReadPageAsync(0, buf).get());
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+  // Scenario: a completed write is visible to asynchronous and synchronous reads alike.
+  EXPECT_TRUE(async_dm.WritePageAsync(0, data).get());
+  EXPECT_TRUE(async_dm.ReadPageAsync(0, buf).get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  std::promise<bool> written;
+  async_dm.WritePageAsync(5, data, [&](bool success) { written.set_value(success); });
+  EXPECT_TRUE(written.get_future().get());
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  // Scenario: the pages in between, which were never written, read as zeroes as well.
+  std::memset(buf, 1, sizeof(buf));
+  EXPECT_TRUE(async_dm.ReadPageAsync(3, buf).get());
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ManyRequestsTest) {
+  DiskManager dm("test.db");
+  const size_t queue_depth = 8;
+  const int num_pages = 256;
+  AsyncDiskManager async_dm(&dm, queue_depth, GetParam());
+
+  // Scenario: far more requests than the queue holds; submissions wait for free slots, and all complete.
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::atomic<int> completed{0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    std::memset(data[page_id].data(), page_id % 128, PAGE_SIZE);
+    async_dm.WritePageAsync(page_id, data[page_id].data(), [&](bool success) {
+      EXPECT_TRUE(success);
+      ++completed;
+    });
+  }
+  async_dm.WaitForAll();
+  EXPECT_EQ(num_pages, completed);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: every page reads back, with the reads in flight at the same time, and the end of the file is tracked.
+  std::vector<std::vector<char>> bufs(num_pages + 1, std::vector<char>(PAGE_SIZE, 1));
+  std::vector<std::future<bool>> reads;
+  for (page_id_t page_id = 0; page_id <= num_pages; ++page_id) {
+    reads.push_back(async_dm.ReadPageAsync(page_id, bufs[page_id].data()));
+  }
+  for (page_id_t page_id = 0; page_id <= num_pages; ++page_id) {
+    EXPECT_TRUE(reads[page_id].get());
+    if (page_id < num_pages) {
+      EXPECT_EQ(data[page_id], bufs[page_id]);
+    } else {
+      EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), bufs[page_id]);
+    }
+  }
+
+  // Scenario: asynchronous writes do not sync either.
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.SyncDataFile();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ShutDownTest) {
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  DiskManager dm("test.db");
+  std::atomic<bool> read{false};
+  {
+    AsyncDiskManager async_dm(&dm, 1, GetParam());
+    if (GetParam() == AsyncDiskManager::Backend::THREAD_POOL) {
+      EXPECT_EQ(AsyncDiskManager::Backend::THREAD_POOL, async_dm.GetBackend());
+    }
+    EXPECT_TRUE(async_dm.WritePageAsync(1, data).get());
+
+    // Scenario: the destructor waits for the requests in flight instead of dropping them.
+    async_dm.ReadPageAsync(1, buf, [&](bool success) { read = success; });
+  }
+  EXPECT_TRUE(read);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ChecksumTest) {
+  char buf[PAGE_SIZE];
+  char data[PAGE_SIZE];
+  std::memset(data, 'x', sizeof(data));
+  DiskManagerOptions options;
+  options.page_checksums = true;
+  DiskManager dm("test.db", options);
+  AsyncDiskManager async_dm(&dm, 4, GetParam());
+
+  // Scenario: asynchronous writes carry checksums like synchronous ones, and leave the caller's page alone.
+  EXPECT_TRUE(async_dm.WritePageAsync(0, data).get());
+  EXPECT_EQ('x', data[PAGE_SIZE - 1]);
+  dm.ReadPage(0, buf);
+  EXPECT_TRUE(DiskManager::IsPageChecksumValid(buf));
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_USABLE_SIZE));
+
+  // Scenario: asynchronous reads verify them.
+  EXPECT_TRUE(async_dm.ReadPageAsync(0, buf).get());
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+  dm.WritePage(1, data);
+  {
+    // Overwrite page 1 behind the checksums' back: page 0 with its checksum, but one byte changed.
+    DiskManager plain("test.db");
+    buf[0] = 'y';
+    plain.WritePage(1, buf);
+  }
+  EXPECT_TRUE(async_dm.ReadPageAsync(1, buf).get());
+  EXPECT_EQ('y', buf[0]);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncDiskManagerBackends, AsyncDiskManagerTest,
+                         ::testing::Values(AsyncDiskManager::Backend::IO_URING,
+                                           AsyncDiskManager::Backend::THREAD_POOL));
+
+}  // namespace bustub
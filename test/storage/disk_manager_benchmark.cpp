@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_benchmark.cpp
+//
+// Identification: test/storage/disk_manager_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "storage/disk/disk_manager.h"
+
+// Measures the page I/O throughput of the DiskManager with a growing number of threads: uniformly random reads and
+// writes of single pages, followed by one SyncDataFile that makes the writes durable. With positioned I/O the threads
+// do not serialize on the DiskManager, so the throughput is bounded by the device and the page cache instead.
+
+namespace bustub {
+
+static double RunRandomIo(DiskManager *disk_manager, uint64_t num_pages, size_t num_threads, uint64_t ops_per_thread,
+                          bool write) {
+  return RunThreads(num_threads, [&](size_t tid) {
+    std::vector<char> data(PAGE_SIZE, static_cast<char>(tid));
+    std::mt19937_64 rng(tid);
+    std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages - 1));
+    for (uint64_t i = 0; i < ops_per_thread; ++i) {
+      if (write) {
+        disk_manager->WritePage(dist(rng), data.data());
+      } else {
+        disk_manager->ReadPage(dist(rng), data.data());
+      }
+    }
+  });
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t max_threads = args.GetInt("threads", std::thread::hardware_concurrency());
+  const uint64_t num_pages = args.GetInt("pages", 16384);
+  const uint64_t ops_per_thread = args.GetInt("ops", 20000);
+  const std::string db_name = args.GetString("db", "disk_manager_bench.db");
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  bustub::DiskManager disk_manager(db_name);
+  // Lay the whole file out first, so that the reads below never go past its end.
+  std::vector<char> data(bustub::PAGE_SIZE, 0);
+  for (uint64_t page_id = 0; page_id < num_pages; ++page_id) {
+    disk_manager.WritePage(static_cast<bustub::page_id_t>(page_id), data.data());
+  }
+  disk_manager.SyncDataFile();
+
+  const double mib = static_cast<double>(bustub::PAGE_SIZE) / (1 << 20);
+  printf("%8s %14s %14s %14s %14s %12s\n", "threads", "read op/s", "read MiB/s", "write op/s", "write MiB/s",
+         "sync ms");
+  for (uint64_t threads = 1; threads <= max_threads; threads *= 2) {
+    const double ops = static_cast<double>(threads * ops_per_thread);
+    const double read_secs = bustub::RunRandomIo(&disk_manager, num_pages, threads, ops_per_thread, false);
+    const double write_secs = bustub::RunRandomIo(&disk_manager, num_pages, threads, ops_per_thread, true);
+    auto start = std::chrono::steady_clock::now();
+    disk_manager.SyncDataFile();
+    const double sync_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%8lu %14.0f %14.1f %14.0f %14.1f %12.2f\n", threads, ops / read_secs, ops / read_secs * mib,
+           ops / write_secs, ops / write_secs * mib, sync_ms);
+    if (threads * 2 > max_threads && threads != max_threads) {
+      threads = max_threads / 2;
+    }
+  }
+
+  disk_manager.ShutDown();
+  remove(db_name.c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  return 0;
+}
@@ -10,11 +10,23 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/memory_disk_manager.h"
+#include "storage/disk/simulated_latency_disk_manager.h"
 
 namespace bustub {
 
@@ -24,12 +36,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.pmap");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.pmap");
   };
 };
 
@@ -55,6 +71,285 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+
+  // Scenario: threads write and read back interleaved pages at the same time, without any serialization.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; ++i) {
+        const page_id_t page_id = i * num_threads + tid;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  // Scenario: every page is still there, and pages beyond the end of the file read as zeroes.
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; ++page_id) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(page_id % 128, buf[PAGE_SIZE - 1]);
+  }
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_threads * pages_per_thread, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+
+  // Scenario: writes do not sync; SyncDataFile does, once per call.
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.SyncDataFile();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeOffsetTest) {
+  char buf[PAGE_SIZE];
+  char data[PAGE_SIZE];
+  std::memset(data, 'x', sizeof(data));
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: a page 3 GB into the database, which is past what a 32-bit offset can address, lands in the fourth
+  // 1 GB segment. The segments in between are created empty, and the files stay sparse.
+  const auto page_id = static_cast<page_id_t>((int64_t{3} << 30) / PAGE_SIZE + 1);
+  dm.WritePage(page_id, data);
+  EXPECT_EQ(4, dm.GetNumSegments());
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(page_id - 1, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+  dm.ShutDown();
+
+  // Scenario: reopening finds all segments, and with them the end of the database.
+  auto reopened = DiskManager(db_file);
+  EXPECT_EQ(4, reopened.GetNumSegments());
+  reopened.ReadPage(page_id, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  std::memset(buf, 1, sizeof(buf));
+  reopened.ReadPage(page_id + 1, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+  reopened.ShutDown();
+  for (int64_t segment = 1; segment < 4; ++segment) {
+    EXPECT_EQ(0, remove(reopened.GetSegmentFileName(segment).c_str()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  const std::string segment_dir = "test_segments";
+  mkdir(segment_dir.c_str(), 0755);
+  DiskManagerOptions options;
+  options.segment_size = 4 * PAGE_SIZE;
+  options.segment_dirs = {".", segment_dir};
+  std::string db_file("test.db");
+  const int num_pages = 10;
+
+  // Scenario: ten pages of four-page segments take three files, the second one in the second directory.
+  {
+    auto dm = DiskManager(db_file, options);
+    char data[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      std::memset(data, page_id, sizeof(data));
+      dm.WritePage(page_id, data);
+    }
+    EXPECT_EQ(3, dm.GetNumSegments());
+    EXPECT_EQ("./test.db.1", dm.GetSegmentFileName(1));
+    EXPECT_EQ(segment_dir + "/test.db.2", dm.GetSegmentFileName(2));
+    dm.SyncDataFile();
+    EXPECT_EQ(1, dm.GetNumSyncs());
+    dm.ShutDown();
+  }
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_EQ(4 * PAGE_SIZE, stat_buf.st_size);
+  ASSERT_EQ(0, stat((segment_dir + "/test.db.2").c_str(), &stat_buf));
+  EXPECT_EQ(2 * PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: the pages read back through a fresh disk manager with the same layout.
+  {
+    auto dm = DiskManager(db_file, options);
+    EXPECT_EQ(3, dm.GetNumSegments());
+    char buf[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id <= num_pages; ++page_id) {
+      dm.ReadPage(page_id, buf);
+      EXPECT_EQ(std::vector<char>(PAGE_SIZE, page_id < num_pages ? page_id : 0),
+                std::vector<char>(buf, buf + PAGE_SIZE));
+    }
+    dm.ShutDown();
+  }
+  remove("test.db.1");
+  remove((segment_dir + "/test.db.2").c_str());
+  rmdir(segment_dir.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char data[PAGE_SIZE] = {0};
+  {
+    DiskManager dm("test.db");
+    for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+      EXPECT_EQ(page_id, dm.AllocatePage());
+    }
+
+    // Scenario: deallocated pages are reused, lowest first, before the database grows.
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(3);
+    EXPECT_FALSE(dm.IsPageAllocated(3));
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(7, dm.AllocatePage());
+    EXPECT_EQ(10, dm.AllocatePage());
+    EXPECT_TRUE(dm.IsPageAllocated(7));
+
+    // Scenario: the allocation survives a shutdown.
+    dm.DeallocatePage(5);
+    dm.WritePage(10, data);
+    dm.ShutDown();
+  }
+  {
+    DiskManager dm("test.db");
+    EXPECT_FALSE(dm.IsPageAllocated(5));
+    EXPECT_TRUE(dm.IsPageAllocated(4));
+    EXPECT_TRUE(dm.IsPageAllocated(10));
+    EXPECT_EQ(5, dm.AllocatePage());
+    EXPECT_EQ(11, dm.AllocatePage());
+
+    // Scenario: without a sync, the changes since the last one are forgotten, except that the pages which made it
+    // into the file stay allocated.
+    dm.DeallocatePage(0);
+    dm.WritePage(12, data);
+  }
+  {
+    DiskManager dm("test.db");
+    EXPECT_TRUE(dm.IsPageAllocated(0));
+    EXPECT_TRUE(dm.IsPageAllocated(11));
+    EXPECT_TRUE(dm.IsPageAllocated(12));
+    EXPECT_EQ(5, dm.AllocatePage());
+    EXPECT_EQ(13, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: a map without its database file starts over.
+  remove("test.db");
+  DiskManager dm("test.db");
+  EXPECT_FALSE(dm.IsPageAllocated(0));
+  EXPECT_EQ(0, dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentAllocationTest) {
+  DiskManager dm("test.db");
+  for (page_id_t page_id = 0; page_id < DB_EXTENT_SIZE; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+
+  // Scenario: a chain whose extent is full moves on to a fresh extent, and continues in it even when unrelated pages
+  // are allocated in between.
+  EXPECT_EQ(DB_EXTENT_SIZE, dm.AllocatePage(DB_EXTENT_SIZE - 1));
+  EXPECT_EQ(DB_EXTENT_SIZE + 1, dm.AllocatePage(DB_EXTENT_SIZE));
+  EXPECT_EQ(DB_EXTENT_SIZE + 2, dm.AllocatePage());
+  EXPECT_EQ(DB_EXTENT_SIZE + 3, dm.AllocatePage(DB_EXTENT_SIZE + 1));
+
+  // Scenario: a fresh extent starts at an extent boundary; unrelated pages fill the gap before it.
+  EXPECT_EQ(2 * DB_EXTENT_SIZE, dm.AllocatePage(DB_EXTENT_SIZE - 1));
+  EXPECT_EQ(DB_EXTENT_SIZE + 4, dm.AllocatePage());
+
+  // Scenario: an extent that has become entirely free is reused for a chain, but a partly free one is not.
+  EXPECT_EQ(DB_EXTENT_SIZE + 5, dm.AllocatePage());
+  EXPECT_EQ(DB_EXTENT_SIZE + 6, dm.AllocatePage());
+  EXPECT_EQ(DB_EXTENT_SIZE + 7, dm.AllocatePage());
+  for (page_id_t page_id = 1; page_id < DB_EXTENT_SIZE; ++page_id) {
+    dm.DeallocatePage(page_id);
+  }
+  dm.DeallocatePage(2 * DB_EXTENT_SIZE);
+  EXPECT_EQ(2 * DB_EXTENT_SIZE, dm.AllocatePage(DB_EXTENT_SIZE + 7));
+  EXPECT_EQ(3 * DB_EXTENT_SIZE, dm.AllocatePage(DB_EXTENT_SIZE + 7));
+  EXPECT_EQ(1, dm.AllocatePage());
+
+  // Scenario: only page ids of the requested residue class are handed out, as for the instances of a parallel pool.
+  EXPECT_EQ(3, dm.AllocatePage(INVALID_PAGE_ID, 3, 0));
+  EXPECT_EQ(5, dm.AllocatePage(3, 2, 1));
+  EXPECT_EQ(2, dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FragmentedExtentAllocationTest) {
+  DiskManager dm("test.db");
+  for (page_id_t page_id = 0; page_id < 16 * DB_EXTENT_SIZE; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+  for (page_id_t page_id = 0; page_id < 16 * DB_EXTENT_SIZE; page_id += DB_EXTENT_SIZE) {
+    dm.DeallocatePage(page_id);
+  }
+
+  // Scenario: with a free page in every extent but no free extent, a chain moves on to a fresh extent.
+  EXPECT_EQ(16 * DB_EXTENT_SIZE, dm.AllocatePage(16 * DB_EXTENT_SIZE - 1));
+  EXPECT_EQ(16 * DB_EXTENT_SIZE + 1, dm.AllocatePage(16 * DB_EXTENT_SIZE));
+
+  // Scenario: an extent below the ones that were passed over becomes entirely free, and is found again.
+  for (page_id_t page_id = 5 * DB_EXTENT_SIZE; page_id < 6 * DB_EXTENT_SIZE; ++page_id) {
+    dm.DeallocatePage(page_id);
+  }
+  EXPECT_EQ(5 * DB_EXTENT_SIZE, dm.AllocatePage(17 * DB_EXTENT_SIZE - 1));
+  EXPECT_EQ(0, dm.AllocatePage());
+
+  // Scenario: a free extent without a page of one residue class is passed over for it, but not for another.
+  for (page_id_t page_id = 6 * DB_EXTENT_SIZE; page_id < 7 * DB_EXTENT_SIZE; ++page_id) {
+    dm.DeallocatePage(page_id);
+  }
+  EXPECT_EQ(17 * DB_EXTENT_SIZE, dm.AllocatePage(17 * DB_EXTENT_SIZE - 1, 2 * DB_EXTENT_SIZE, DB_EXTENT_SIZE));
+  EXPECT_EQ(6 * DB_EXTENT_SIZE, dm.AllocatePage(17 * DB_EXTENT_SIZE, 2 * DB_EXTENT_SIZE, 0));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ResidueAllocationTest) {
+  DiskManager dm("test.db");
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+  }
+  for (page_id_t page_id = 0; page_id < 16; page_id += 2) {
+    dm.DeallocatePage(page_id);
+  }
+
+  // Scenario: the free pages of one residue class do not hold up the others, and are still handed out in order.
+  EXPECT_EQ(17, dm.AllocatePage(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(19, dm.AllocatePage(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(0, dm.AllocatePage(INVALID_PAGE_ID, 2, 0));
+  EXPECT_EQ(2, dm.AllocatePage(INVALID_PAGE_ID, 2, 0));
+
+  // Scenario: a page that is freed below the pages handed out so far is reused first.
+  dm.DeallocatePage(5);
+  EXPECT_EQ(5, dm.AllocatePage(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(4, dm.AllocatePage(INVALID_PAGE_ID, 2, 0));
+  EXPECT_EQ(21, dm.AllocatePage(INVALID_PAGE_ID, 2, 1));
+
+  // Scenario: a different stride starts over from the lowest free page, and so does an allocation without one.
+  EXPECT_EQ(6, dm.AllocatePage(INVALID_PAGE_ID, 3, 0));
+  EXPECT_EQ(8, dm.AllocatePage(INVALID_PAGE_ID, 4, 0));
+  EXPECT_EQ(10, dm.AllocatePage());
+  EXPECT_EQ(12, dm.AllocatePage(INVALID_PAGE_ID, 2, 0));
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +367,305 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MemoryDiskManagerTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  MemoryDiskManager memory_dm;
+  DiskManager *dm = &memory_dm;
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: pages that were never written read as zeroes and take no memory.
+  std::memset(buf, 1, sizeof(buf));
+  dm->ReadPage(1 << 20, buf);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), std::vector<char>(buf, buf + PAGE_SIZE));
+  EXPECT_EQ(0, memory_dm.GetNumPages());
+
+  // Scenario: written pages read back, and are counted like the pages of a file.
+  dm->WritePage(0, data);
+  dm->WritePage(1 << 20, data);
+  dm->ReadPage(1 << 20, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, memory_dm.GetNumPages());
+  EXPECT_EQ(2, dm->GetNumWrites());
+  dm->SyncDataFile();
+  EXPECT_EQ(1, dm->GetNumSyncs());
+
+  // Scenario: allocation reuses pages as for a file, and the log reads back.
+  EXPECT_EQ(0, dm->AllocatePage());
+  EXPECT_EQ(1, dm->AllocatePage());
+  dm->DeallocatePage(0);
+  EXPECT_EQ(0, dm->AllocatePage());
+  dm->WriteLog(data, 20);
+  EXPECT_TRUE(dm->ReadLog(buf, 10, 5));
+  EXPECT_EQ(std::memcmp(buf, data + 5, 10), 0);
+  EXPECT_FALSE(dm->ReadLog(buf, 10, 20));
+  EXPECT_FALSE(std::ifstream("test.db").good());
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SimulatedLatencyTest) {
+  char buf[PAGE_SIZE] = {0};
+  MemoryDiskManager memory_dm;
+  SimulatedLatencyOptions options;
+  options.read_latency = std::chrono::milliseconds(5);
+  options.write_latency = std::chrono::milliseconds(2);
+  // One page per millisecond.
+  options.bandwidth = PAGE_SIZE * 1000;
+  SimulatedLatencyDiskManager dm(&memory_dm, options);
+
+  // Scenario: a single request takes its latency plus one transfer.
+  auto start = std::chrono::steady_clock::now();
+  dm.WritePage(0, buf);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(3));
+  EXPECT_EQ(1, dm.GetNumWrites());
+  EXPECT_EQ(1, memory_dm.GetNumPages());
+
+  // Scenario: concurrent requests overlap their latencies, but take turns in the bandwidth.
+  const int num_threads = 8;
+  start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&dm] {
+      char page[PAGE_SIZE];
+      dm.ReadPage(0, page);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed, std::chrono::milliseconds(num_threads + 5));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(num_threads * 6));
+
+  // Scenario: allocation goes to the wrapped disk manager.
+  EXPECT_EQ(0, dm.AllocatePage());
+  EXPECT_TRUE(memory_dm.IsPageAllocated(0));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  // One aligned page buffer, and one that is deliberately not aligned.
+  auto *aligned = static_cast<char *>(::operator new[](PAGE_SIZE, std::align_val_t{DIRECT_IO_ALIGNMENT}));
+  std::vector<char> storage(PAGE_SIZE + 1);
+  char *unaligned = storage.data() + (reinterpret_cast<uintptr_t>(storage.data()) % 2 == 0 ? 1 : 0);
+  char buf[PAGE_SIZE];
+
+  {
+    DiskManagerOptions options;
+    options.direct_io = true;
+    // Small segments, so that segments created later are opened for direct I/O as well.
+    options.segment_size = 2 * PAGE_SIZE;
+    DiskManager dm("test.db", options);
+
+    // Scenario: pages in aligned and unaligned buffers round-trip, whether the file system supports direct I/O or
+    // the disk manager fell back to buffered I/O.
+    for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+      char *data = page_id % 2 == 0 ? aligned : unaligned;
+      memset(data, 'a' + page_id, PAGE_SIZE);
+      dm.WritePage(page_id, data);
+    }
+    for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+      char *data = page_id % 2 == 0 ? unaligned : aligned;
+      dm.ReadPage(page_id, data);
+      EXPECT_EQ(std::string(PAGE_SIZE, 'a' + page_id), std::string(data, PAGE_SIZE));
+    }
+    EXPECT_EQ(2, dm.GetNumSegments());
+    // Scenario: pages beyond the end of the file still read as zeroes.
+    dm.ReadPage(9, unaligned);
+    EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(unaligned, PAGE_SIZE));
+    dm.ShutDown();
+  }
+
+  // Scenario: buffered I/O sees the same pages.
+  DiskManager dm("test.db", DiskManagerOptions{2 * PAGE_SIZE, {}, false});
+  EXPECT_FALSE(dm.UsesDirectIO());
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::string(PAGE_SIZE, 'd'), std::string(buf, PAGE_SIZE));
+  dm.ShutDown();
+  remove("test.db.1");
+  ::operator delete[](aligned, std::align_val_t{DIRECT_IO_ALIGNMENT});
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::memset(data, 'x', sizeof(data));
+  DiskManagerOptions options;
+  options.page_checksums = true;
+  DiskManager dm("test.db", options);
+  EXPECT_TRUE(dm.VerifiesChecksums());
+
+  // Scenario: a written page reads back with its checksum in the trailer, while the caller's page stays untouched.
+  dm.WritePage(0, data);
+  dm.WritePage(2, data);
+  EXPECT_EQ('x', data[PAGE_SIZE - 1]);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_USABLE_SIZE));
+  EXPECT_TRUE(DiskManager::IsPageChecksumValid(buf));
+  EXPECT_FALSE(DiskManager::IsPageChecksumValid(data));
+
+  // Scenario: the page in between was never written; it reads as zeroes, which is not a checksum failure.
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: a byte that flips on disk is detected when the page is read, but the page is returned nonetheless.
+  {
+    std::fstream file("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(2 * PAGE_SIZE + 100);
+    file.put('y');
+  }
+  dm.ReadPage(2, buf);
+  EXPECT_EQ('y', buf[100]);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  // Scenario: with verification switched off, the page is not checked.
+  dm.SetVerifyChecksums(false);
+  EXPECT_FALSE(dm.VerifiesChecksums());
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  dm.SetVerifyChecksums(true);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(2, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+
+  // Scenario: without page checksums, pages round-trip byte for byte and verification cannot be switched on.
+  DiskManager plain("test.db");
+  plain.SetVerifyChecksums(true);
+  EXPECT_FALSE(plain.VerifiesChecksums());
+  plain.WritePage(3, data);
+  plain.ReadPage(3, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+  plain.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionTest) {
+  auto file_size = [] {
+    struct stat stat_buf;
+    return stat("test.db", &stat_buf) == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
+  };
+  char zeroes[PAGE_SIZE] = {0};
+  char text[PAGE_SIZE] = {0};
+  char noise[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  std::mt19937 rng(0);
+  for (auto &c : noise) {
+    c = static_cast<char>(rng());
+  }
+  for (int i = 0; i + 16 <= PAGE_SIZE / 2; i += 16) {
+    const std::string number = std::to_string(i / 16);
+    const std::string tuple = "tuple " + std::string(9 - number.size(), '0') + number;
+    memcpy(text + i, tuple.data(), tuple.size());
+  }
+  DiskManagerOptions options;
+  options.compression = true;
+  options.page_checksums = true;
+  options.direct_io = true;
+
+  // Scenario: compressible pages take a fraction of a page each, and pages of zeroes take nothing.
+  {
+    DiskManager dm("test.db", options);
+    EXPECT_TRUE(dm.UsesCompression());
+    EXPECT_FALSE(dm.UsesDirectIO());
+    EXPECT_FALSE(dm.IsFileBacked());
+    for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+      text[PAGE_SIZE / 2] = static_cast<char>('a' + page_id);
+      dm.WritePage(page_id, text);
+    }
+    dm.WritePage(16, zeroes);
+    dm.WritePage(17, noise);
+    EXPECT_LT(file_size(), 8 * PAGE_SIZE);
+    dm.ReadPage(3, buf);
+    text[PAGE_SIZE / 2] = 'd';
+    EXPECT_EQ(0, std::memcmp(buf, text, PAGE_USABLE_SIZE));
+    dm.ReadPage(16, buf);
+    EXPECT_EQ(0, std::memcmp(buf, zeroes, PAGE_SIZE));
+    dm.ReadPage(17, buf);
+    EXPECT_EQ(0, std::memcmp(buf, noise, PAGE_USABLE_SIZE));
+    dm.ReadPage(18, buf);
+    EXPECT_EQ(0, std::memcmp(buf, zeroes, PAGE_SIZE));
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+
+  // Scenario: after reopening, the extent map finds every page again, and the database has its logical size.
+  const int64_t synced_size = file_size();
+  {
+    DiskManager dm("test.db", options);
+    std::vector<page_id_t> snapshot{17, 18};
+    EXPECT_TRUE(dm.WriteSnapshot(snapshot));
+    EXPECT_TRUE(dm.ReadSnapshot(&snapshot));
+    EXPECT_EQ(std::vector<page_id_t>{17}, snapshot);
+    for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+      dm.ReadPage(page_id, buf);
+      text[PAGE_SIZE / 2] = static_cast<char>('a' + page_id);
+      EXPECT_EQ(0, std::memcmp(buf, text, PAGE_USABLE_SIZE));
+    }
+    dm.ReadPage(17, buf);
+    EXPECT_EQ(0, std::memcmp(buf, noise, PAGE_USABLE_SIZE));
+
+    // Scenario: a page that moves leaves its old sectors alone until the sync, and later pages reuse them.
+    dm.WritePage(17, text);
+    dm.DeallocatePage(5);
+    EXPECT_GT(file_size(), synced_size);
+    const int64_t moved_size = file_size();
+    dm.SyncDataFile();
+    dm.WritePage(18, noise);
+    dm.WritePage(19, text);
+    EXPECT_EQ(moved_size, file_size());
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(0, std::memcmp(buf, zeroes, PAGE_SIZE));
+    dm.ReadPage(18, buf);
+    EXPECT_EQ(0, std::memcmp(buf, noise, PAGE_USABLE_SIZE));
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+  remove("test.snapshot");
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  DiskManagerOptions options;
+  options.segment_size = 4 * PAGE_SIZE;
+  options.page_checksums = true;
+  DiskManager dm("test.db", options);
+  std::vector<std::vector<char>> data(8, std::vector<char>(PAGE_SIZE));
+  for (size_t i = 0; i < data.size(); ++i) {
+    std::snprintf(data[i].data(), PAGE_SIZE, "page %zu", i);
+  }
+
+  // Scenario: runs of consecutive pages, one of which crosses into the next segment, are written like single pages.
+  const std::vector<page_id_t> page_ids{0, 1, 2, 3, 4, 5, 7};
+  std::vector<const char *> pages;
+  for (auto page_id : page_ids) {
+    pages.push_back(data[page_id].data());
+  }
+  dm.WritePages(page_ids, pages);
+  EXPECT_EQ(static_cast<int>(page_ids.size()), dm.GetNumWrites());
+  EXPECT_EQ(2, dm.GetNumSegments());
+  char buf[PAGE_SIZE];
+  for (auto page_id : page_ids) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(0, std::memcmp(buf, data[page_id].data(), PAGE_USABLE_SIZE));
+  }
+  dm.ReadPage(6, buf);
+  EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: a disk manager without files writes the batch page by page.
+  MemoryDiskManager memory;
+  memory.WritePages(page_ids, pages);
+  EXPECT_EQ(page_ids.size(), memory.GetNumPages());
+  memory.ReadPage(7, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data[7].data(), PAGE_SIZE));
+  dm.ShutDown();
+  remove("test.db.1");
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
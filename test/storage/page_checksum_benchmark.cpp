@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksum_benchmark.cpp
+//
+// Identification: test/storage/page_checksum_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "common/util/crc32c.h"
+#include "storage/disk/disk_manager.h"
+
+// Measures what page checksums cost: first the CRC32C of one page on its own, with the processor's instructions and
+// with the portable tables, then random single-page reads and writes through a DiskManager without checksums, with
+// checksums that are only written, and with checksums that are also verified. --direct_io=1 takes the page cache out
+// of the picture, so that the reads and writes reach the device.
+
+namespace bustub {
+
+/** @return the nanoseconds per page that crc takes */
+template <typename F>
+static double TimeChecksum(const std::vector<char> &page, uint64_t iterations, F crc) {
+  volatile uint32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; ++i) {
+    sink = sink + crc(page.data(), page.size());
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         static_cast<double>(iterations);
+}
+
+/** @return the microseconds per random page read or write */
+static double TimeRandomIo(DiskManager *disk_manager, uint64_t num_pages, uint64_t ops, bool write) {
+  std::vector<char> data(PAGE_SIZE, 'x');
+  std::mt19937_64 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, static_cast<page_id_t>(num_pages - 1));
+  auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < ops; ++i) {
+    if (write) {
+      disk_manager->WritePage(dist(rng), data.data());
+    } else {
+      disk_manager->ReadPage(dist(rng), data.data());
+    }
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+         static_cast<double>(ops);
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t iterations = args.GetInt("iterations", 1000000);
+  const uint64_t num_pages = args.GetInt("pages", 16384);
+  const uint64_t ops = args.GetInt("ops", 100000);
+  const bool direct_io = args.GetInt("direct_io", 0) != 0;
+  const std::string db_name = args.GetString("db", "page_checksum_bench.db");
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  std::vector<char> page(bustub::PAGE_SIZE);
+  std::mt19937 rng(0);
+  for (auto &c : page) {
+    c = static_cast<char>(rng());
+  }
+  const double hardware_ns = bustub::TimeChecksum(
+      page, iterations, [](const char *data, size_t length) { return bustub::Crc32c::Value(data, length); });
+  const double portable_ns = bustub::TimeChecksum(page, iterations, [](const char *data, size_t length) {
+    return bustub::Crc32c::ExtendPortable(0, data, length);
+  });
+  printf("crc32c of a %d byte page: %.0f ns %s, %.0f ns portable\n\n", bustub::PAGE_SIZE, hardware_ns,
+         bustub::Crc32c::IsHardwareAccelerated() ? "with CRC32C instructions" : "(no CRC32C instructions)",
+         portable_ns);
+
+  printf("%10s %14s %14s %12s %12s\n", "checksums", "read us/page", "write us/page", "read cost", "write cost");
+  double base_read_us = 0;
+  double base_write_us = 0;
+  for (const char *mode : {"off", "write", "verify"}) {
+    bustub::DiskManagerOptions options;
+    options.direct_io = direct_io;
+    options.page_checksums = std::string(mode) != "off";
+    options.verify_checksums = std::string(mode) == "verify";
+    bustub::DiskManager disk_manager(db_name, options);
+    // Lay the whole file out first, so that every read finds a written page with a checksum to verify.
+    for (uint64_t page_id = 0; page_id < num_pages; ++page_id) {
+      disk_manager.WritePage(static_cast<bustub::page_id_t>(page_id), page.data());
+    }
+    disk_manager.SyncDataFile();
+    const double write_us = bustub::TimeRandomIo(&disk_manager, num_pages, ops, true);
+    const double read_us = bustub::TimeRandomIo(&disk_manager, num_pages, ops, false);
+    if (base_read_us == 0) {
+      base_read_us = read_us;
+      base_write_us = write_us;
+    }
+    printf("%10s %14.2f %14.2f %11.1f%% %11.1f%%\n", mode, read_us, write_us, (read_us / base_read_us - 1) * 100,
+           (write_us / base_write_us - 1) * 100);
+    disk_manager.ShutDown();
+    remove(db_name.c_str());
+  }
+
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  return 0;
+}
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  {
+    // Scenario: a new page is pinned once and unpinned dirty when its guard goes out of scope.
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(page_id, guard.PageId());
+    snprintf(guard.GetDataMut(), PAGE_SIZE, "Hello");
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    bpm->UnpinPage(page_id, false);
+  }
+  Page *page = bpm->FetchPage(page_id);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  bpm->UnpinPage(page_id, false);
+  bpm->FlushPage(page_id);
+
+  {
+    // Scenario: moving a guard hands its pin over instead of taking another one.
+    auto guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    BasicPageGuard moved(std::move(guard));
+    EXPECT_FALSE(guard.IsValid());  // NOLINT
+    EXPECT_TRUE(moved.IsValid());
+    EXPECT_EQ(1, page->GetPinCount());
+
+    // Scenario: assigning to a guard drops the page it held.
+    auto other = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    other = std::move(moved);
+    EXPECT_EQ(1, page->GetPinCount());
+
+    // Scenario: a page that is only read through its guard is unpinned clean; dropping twice is harmless.
+    EXPECT_EQ(0, strcmp(other.GetData(), "Hello"));
+    other.Drop();
+    other.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_FALSE(page->IsDirty());
+  }
+
+  {
+    // Scenario: upgrading keeps the pin and takes the latch, which the guard releases before unpinning.
+    auto read_guard = bpm->FetchPageBasic(page_id).UpgradeRead();
+    auto other_read_guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(read_guard.GetData(), other_read_guard.GetData()));
+  }
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(write_guard.GetDataMut(), PAGE_SIZE, "World");
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_EQ(0, strcmp(bpm->FetchPageRead(page_id).GetData(), "World"));
+
+  // Scenario: a failed fetch yields an empty guard.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t temp_page_id;
+    guards.push_back(bpm->NewPageGuarded(&temp_page_id));
+    EXPECT_TRUE(guards.back().IsValid());
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(page_id).IsValid());
+  guards.clear();
+  EXPECT_TRUE(bpm->FetchPageRead(page_id).IsValid());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_size_benchmark.cpp
+//
+// Identification: test/storage/page_size_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark_util.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/b_plus_tree_test_util.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+// Measures how the page size affects a table scan and indexed point lookups, with the same buffer pool memory for
+// every page size. The page size is fixed at build time, so compare builds configured with -DBUSTUB_PAGE_SIZE=4096,
+// 16384 and 65536; each run prints one row. Larger pages mean fewer page hops per scanned tuple and a higher B+ tree
+// fanout, but also fewer frames for the same memory and more bytes read per miss.
+
+namespace bustub {
+
+/** Entries per leaf of the index, i.e. LEAF_PAGE_SIZE for its key type. */
+static constexpr size_t LEAF_FANOUT =
+    (PAGE_USABLE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+
+/** @return the seconds that fn takes */
+template <typename F>
+static double Time(F fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace bustub
+
+int main(int argc, char **argv) {
+  using bustub::BPlusTree;
+  using bustub::GenericComparator;
+  using bustub::GenericKey;
+  using bustub::RID;
+  bustub::BenchmarkArgs args(argc, argv);
+  const uint64_t num_tuples = args.GetInt("tuples", 20000);
+  const uint64_t tuple_bytes = args.GetInt("tuple_bytes", 100);
+  const uint64_t num_lookups = args.GetInt("lookups", 200000);
+  const uint64_t pool_mib = args.GetInt("pool_mib", 1);
+  const std::string db_name = args.GetString("db", "page_size_bench.db");
+  if (args.WantsHelp()) {
+    args.PrintUsage(argv[0]);
+    return 0;
+  }
+
+  auto disk_manager = std::make_unique<bustub::DiskManager>(db_name);
+  const size_t pool_size = (pool_mib << 20) / bustub::PAGE_SIZE;
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::Transaction txn(0);
+
+  // The B+ tree records its root in the header page, which has to be page 0.
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  std::unique_ptr<bustub::Schema> key_schema(bustub::ParseCreateStatement("a bigint"));
+  GenericComparator<8> comparator(key_schema.get());
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("page_size_bench", bpm.get(), comparator);
+  bustub::Schema schema({bustub::Column("a", bustub::TypeId::BIGINT),
+                         bustub::Column("b", bustub::TypeId::VARCHAR, static_cast<uint32_t>(tuple_bytes))});
+  bustub::TableHeap table(bpm.get(), nullptr, nullptr, &txn);
+
+  // Load the table in key order and index every tuple. TableHeap::InsertTuple walks the page chain from the start, so
+  // the load is quadratic and not measured.
+  const std::string payload(tuple_bytes, 'x');
+  {
+    GenericKey<8> key;
+    for (uint64_t i = 0; i < num_tuples; ++i) {
+      bustub::Tuple tuple({bustub::ValueFactory::GetBigIntValue(static_cast<int64_t>(i)),
+                           bustub::ValueFactory::GetVarcharValue(payload)},
+                          &schema);
+      RID rid;
+      table.InsertTuple(tuple, &rid, &txn);
+      key.SetFromInteger(static_cast<int64_t>(i));
+      tree.Insert(key, rid, &txn);
+    }
+  }
+  bpm->FlushAllPages();
+
+  // Scan the whole table twice; the first scan starts from whatever the load left in the pool.
+  uint64_t scanned = 0;
+  const double scan_secs = bustub::Time([&] {
+    for (int round = 0; round < 2; ++round) {
+      for (auto it = table.Begin(&txn); it != table.End(); ++it) {
+        scanned += it->GetLength() > 0 ? 1 : 0;
+      }
+    }
+  });
+
+  // Look up random keys in the index and fetch their tuples from the table.
+  uint64_t found = 0;
+  const double lookup_secs = bustub::Time([&] {
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<int64_t> dist(0, static_cast<int64_t>(num_tuples - 1));
+    GenericKey<8> key;
+    std::vector<RID> rids;
+    bustub::Tuple tuple;
+    for (uint64_t i = 0; i < num_lookups; ++i) {
+      key.SetFromInteger(dist(rng));
+      rids.clear();
+      if (tree.GetValue(key, &rids, &txn) && table.GetTuple(rids[0], &tuple, &txn)) {
+        ++found;
+      }
+    }
+  });
+
+  printf("%8s %8s %11s %14s %14s %10s\n", "page KiB", "frames", "leaf fanout", "scan tuple/s", "lookup op/s",
+         "found");
+  printf("%8d %8zu %11zu %14.0f %14.0f %10lu\n", bustub::PAGE_SIZE / 1024, pool_size, bustub::LEAF_FANOUT,
+         static_cast<double>(scanned) / scan_secs, static_cast<double>(num_lookups) / lookup_secs, found);
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".log").c_str());
+  remove((db_name.substr(0, db_name.rfind('.')) + ".fsm").c_str());
+  return 0;
+}
@@ -16,11 +16,12 @@
 #include <string>
 #include <vector>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -39,7 +40,7 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   // create transaction
   auto *transaction = new Transaction(0);
   auto *disk_manager = new DiskManager("test.db");
-  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
   auto *lock_manager = new LockManager();
   auto *log_manager = new LogManager(disk_manager);
   auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
@@ -71,4 +72,79 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableHeapScanTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 100};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const int num_tuples = 2000;
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  // A pool much smaller than the table, so that the scan has to read pages back in, read-ahead included.
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; ++i) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i),
+                              ValueFactory::GetVarcharValue(std::string(i % 100, 'x'))};
+    Tuple tuple(values, &schema);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rids.push_back(rid);
+  }
+
+  // Scenario: a scan returns every tuple exactly once.
+  for (int round = 0; round < 2; ++round) {
+    std::vector<bool> seen(num_tuples, false);
+    int count = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      int32_t value = itr->GetValue(&schema, 0).GetAs<int32_t>();
+      ASSERT_TRUE(value >= 0 && value < num_tuples);
+      EXPECT_FALSE(seen[value]);
+      seen[value] = true;
+      EXPECT_EQ(std::string(value % 100, 'x'), itr->GetValue(&schema, 1).ToString());
+      ++count;
+    }
+    EXPECT_EQ(num_tuples, count);
+  }
+
+  // Scenario: a batched read of shuffled rids returns every tuple at the position of its rid. The rids span fewer
+  // pages than the pool has frames.
+  std::vector<RID> shuffled_rids(rids.begin(), rids.begin() + 200);
+  std::shuffle(shuffled_rids.begin(), shuffled_rids.end(), std::default_random_engine(0));
+  std::vector<Tuple> tuples;
+  ASSERT_TRUE(table->GetTuples(shuffled_rids, &tuples, transaction));
+  ASSERT_EQ(shuffled_rids.size(), tuples.size());
+  for (size_t i = 0; i < shuffled_rids.size(); ++i) {
+    EXPECT_EQ(shuffled_rids[i], tuples[i].GetRid());
+  }
+
+  // Scenario: point reads and deletes of every tuple go through a pool of 10 frames. Any page left pinned by the
+  // table heap would soon exhaust it and make the fetches fail.
+  for (const auto &rid : rids) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rid, &tuple, transaction));
+    ASSERT_TRUE(table->MarkDelete(rid, transaction));
+  }
+  for (size_t i = 0; i < buffer_pool_manager->GetPoolSize(); ++i) {
+    EXPECT_EQ(0, buffer_pool_manager->GetPages()[i].GetPinCount());
+  }
+
+  delete table;
+  delete buffer_pool_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+  delete log_manager;
+  delete lock_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub